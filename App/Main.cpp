@@ -76,7 +76,7 @@ int panel = 0x09E69;
 HWND hwndSeed, hwndRandomize, hwndCol, hwndRow, hwndElem, hwndColor, hwndLoadingText, hwndNormal, hwndExpert, hwndColorblind, hwndDoubleMode;
 std::shared_ptr<Panel> _panel;
 std::shared_ptr<Randomizer> randomizer = std::make_shared<Randomizer>();
-std::shared_ptr<Generate> generator = std::make_shared<Generate>();
+std::shared_ptr<Generate> generator = std::make_shared<Generate>(std::make_shared<Random>());
 std::shared_ptr<Special> specialCase = std::make_shared<Special>(generator);
 std::vector<byte> bytes;
 
@@ -161,9 +161,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 			if (seed <= 0 || seed > 9999999) {
 				if (text[0] == 0) {
 					//If no seed is entered, pick random seed
-					Random::seed(static_cast<int>(time(NULL)));
-					seed = Random::rand() % 9999999 + 1;
-					Random::seed(seed);
+					seed = Random(static_cast<int>(time(NULL))).rand() % 9999999 + 1;
 					randomizer->seedIsRNG = true;
 				}
 				else {
@@ -244,7 +242,10 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam)
 			randomizer->seed = seed;
 			randomizer->colorblind = IsDlgButtonChecked(hwnd, IDC_COLORBLIND);
 			randomizer->doubleMode = doubleMode;
-			if (hard) randomizer->GenerateHard(hwndLoadingText);
+			//Use a pregenerated world if one is available (see -pregenerate below)
+			std::shared_ptr<WorldImage> cachedWorld = rerandomize ? nullptr : WorldImage::LoadCached(randomizer->GetWorldKey(hard));
+			if (cachedWorld) randomizer->ApplyWorldImage(cachedWorld, hwndLoadingText);
+			else if (hard) randomizer->GenerateHard(hwndLoadingText);
 			else randomizer->GenerateNormal(hwndLoadingText);
 			Special::WritePanelData(0x00064, BACKGROUND_REGION_COLOR + 12, seed);
 			Special::WritePanelData(0x00182, BACKGROUND_REGION_COLOR + 12, hard);
@@ -449,6 +450,81 @@ int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance
 	}
 	Memory::showMsg = true;
 
+	//"-threads <n>" generates the areas in parallel (see PuzzleList::GenerateAreas). This gives different puzzles for a seed than the default, one area after another.
+	//"-attempts <k>" (with -threads) makes up to k attempts at once on panels that take many tries, without changing the puzzles (see Generate::retry).
+	//"-profile" writes the attempts at each panel and the time spent on each stage of them to WRPGprofile.csv, slowest panels first (see Profiler).
+	//"-verify" checks every panel with the Solver while generating, and generates it again if it can't be solved (see Generate::setVerify).
+	//Batch mode - "-pregenerate <first seed> <last seed> [-expert] [-double] [-colorblind] [-threads <n>] [-attempts <k>] [-verify]" fills the world cache without opening the window
+	//"-countmazes <first seed> <last seed>" writes the solution counts of the tutorial mazes to WRPGmazes.csv instead (see Randomizer::CountMazeSolutions)
+	//"-benchmark <first seed> <last seed>" (with the same options as -pregenerate) writes the generation times to WRPGbenchmark.json instead (see Randomizer::BenchmarkWorlds)
+	//"-golden <file> [-record]" checks that the worlds listed in a golden hash file (such as GoldenHashes.txt) are still generated the same, or records them (see Randomizer::CheckGoldenHashes)
+	//"-determinism <first seed> <last seed> [-expert]" checks that those seeds give the same worlds every time, with and without threads (see Randomizer::CheckDeterminism)
+	std::wstringstream cmdLine(lpCmdLine);
+	std::wstring arg;
+	int firstSeed = 0, finalSeed = -1;
+	bool pregenerate = false, countMazes = false, benchmark = false, record = false, determinism = false;
+	std::wstring goldenFile;
+	while (cmdLine >> arg) {
+		if (arg == L"-pregenerate") {
+			pregenerate = true;
+			cmdLine >> firstSeed >> finalSeed;
+		}
+		else if (arg == L"-countmazes") {
+			countMazes = true;
+			cmdLine >> firstSeed >> finalSeed;
+		}
+		else if (arg == L"-benchmark") {
+			benchmark = true;
+			cmdLine >> firstSeed >> finalSeed;
+		}
+		else if (arg == L"-determinism") {
+			determinism = true;
+			cmdLine >> firstSeed >> finalSeed;
+		}
+		else if (arg == L"-golden") cmdLine >> goldenFile;
+		else if (arg == L"-record") record = true;
+		else if (arg == L"-expert") hard = true;
+		else if (arg == L"-double") randomizer->doubleMode = true;
+		else if (arg == L"-colorblind") randomizer->colorblind = true;
+		else if (arg == L"-threads") cmdLine >> randomizer->threads;
+		else if (arg == L"-attempts") cmdLine >> randomizer->parallelAttempts;
+		else if (arg == L"-verify") randomizer->verify = true;
+		else if (arg == L"-profile") randomizer->profile = true;
+	}
+	if (pregenerate || countMazes || benchmark || determinism || goldenFile.size() > 0) {
+		if (Special::ReadPanelData<int>(0x00064, NUM_DOTS) > 5) {
+			MessageBox(GetActiveWindow(), L"The game is currently randomized. Please start a new game before pregenerating worlds.", NULL, MB_OK);
+			return 0;
+		}
+		if (countMazes) {
+			bool written = randomizer->CountMazeSolutions(max(firstSeed, 1), min(finalSeed, 9999999), "WRPGmazes.csv");
+			MessageBox(GetActiveWindow(), written ? L"Maze solution counts written to WRPGmazes.csv." : L"Couldn't write WRPGmazes.csv.", L"", MB_OK);
+			return 0;
+		}
+		if (goldenFile.size() > 0) {
+			std::string report = randomizer->CheckGoldenHashes(std::string(goldenFile.begin(), goldenFile.end()), record);
+			bool failed = (report.size() > 0);
+			if (!failed) report = record ? "Golden hashes recorded." : "Every world matches its golden hashes.";
+			MessageBoxA(GetActiveWindow(), report.c_str(), "", MB_OK);
+			return failed ? 1 : 0; //So that a script running the check can tell
+		}
+		if (determinism) {
+			std::string report = randomizer->CheckDeterminism(max(firstSeed, 1), min(finalSeed, 9999999), hard);
+			bool failed = (report.size() > 0);
+			if (!failed) report = "Every seed gave the same world each time.";
+			MessageBoxA(GetActiveWindow(), report.c_str(), "", MB_OK);
+			return failed ? 1 : 0;
+		}
+		if (benchmark) {
+			bool written = randomizer->BenchmarkWorlds(max(firstSeed, 1), min(finalSeed, 9999999), hard, "WRPGbenchmark.json");
+			MessageBox(GetActiveWindow(), written ? L"Generation times written to WRPGbenchmark.json." : L"Couldn't write WRPGbenchmark.json.", L"", MB_OK);
+			return 0;
+		}
+		int numGenerated = randomizer->PregenerateWorlds(max(firstSeed, 1), min(finalSeed, 9999999), hard);
+		MessageBox(GetActiveWindow(), (L"Added " + std::to_wstring(numGenerated) + L" worlds to the world cache.").c_str(), L"", MB_OK);
+		return 0;
+	}
+
 	//Get the seed and difficulty previously used for this save file (if applicable)
 	int lastSeed = Special::ReadPanelData<int>(0x00064, BACKGROUND_REGION_COLOR + 12);
 	hard = (Special::ReadPanelData<int>(0x00182, BACKGROUND_REGION_COLOR + 12) > 0);
@@ -0,0 +1,99 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Benchmark.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+
+thread_local Benchmark::AreaTimer* Benchmark::_current = nullptr;
+
+void Benchmark::PanelWritten(int panel)
+{
+	AreaTimer* area = _current;
+	if (!area) return;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double milliseconds = std::chrono::duration<double, std::milli>(now - area->_panelStart).count();
+	area->_panelStart = now;
+	std::lock_guard<std::mutex> guard(area->_benchmark->_lock);
+	area->_benchmark->_newPanels.push_back({ panel, area->_area, milliseconds });
+}
+
+void Benchmark::AddArea(const std::string& area, double milliseconds)
+{
+	std::lock_guard<std::mutex> guard(_lock);
+	_newAreas.push_back({ area, milliseconds });
+}
+
+void Benchmark::AddWorld(double milliseconds)
+{
+	std::lock_guard<std::mutex> guard(_lock);
+	_worlds.push_back(milliseconds);
+	for (const PanelTime& time : _newPanels) {
+		_panels[time.panel].push_back(time.milliseconds);
+		_areaPanels[time.area].push_back(time.milliseconds);
+		_allPanels.push_back(time.milliseconds);
+	}
+	for (const std::pair<std::string, double>& area : _newAreas) {
+		_areas[area.first].push_back(area.second);
+	}
+	_newPanels.clear();
+	_newAreas.clear();
+}
+
+void Benchmark::DiscardWorld()
+{
+	std::lock_guard<std::mutex> guard(_lock);
+	_newPanels.clear();
+	_newAreas.clear();
+}
+
+bool Benchmark::WriteJSON(const std::string& filename, const std::string& config)
+{
+	std::lock_guard<std::mutex> guard(_lock);
+	std::ofstream file(filename, std::ofstream::trunc);
+	if (!file) return false;
+	double seconds = std::accumulate(_worlds.begin(), _worlds.end(), 0.0) / 1000;
+	file << std::fixed << std::setprecision(3);
+	file << "{" << std::endl;
+	file << "  \"config\": \"" << config << "\"," << std::endl;
+	file << "  \"worlds\": " << _worlds.size() << "," << std::endl;
+	file << "  \"panels\": " << _allPanels.size() << "," << std::endl;
+	file << "  \"seconds\": " << seconds << "," << std::endl;
+	file << "  \"worlds_per_second\": " << (seconds > 0 ? _worlds.size() / seconds : 0) << "," << std::endl;
+	file << "  \"panels_per_second\": " << (seconds > 0 ? _allPanels.size() / seconds : 0) << "," << std::endl;
+	file << "  \"world_ms\": ";
+	WriteLatencies(file, _worlds);
+	file << "," << std::endl << "  \"panel_ms\": ";
+	WriteLatencies(file, _allPanels);
+	file << "," << std::endl << "  \"areas\": {";
+	bool first = true;
+	for (const std::pair<const std::string, std::vector<double>>& area : _areas) {
+		file << (first ? "" : ",") << std::endl << "    \"" << area.first << "\": { \"area_ms\": ";
+		WriteLatencies(file, area.second);
+		file << ", \"panel_ms\": ";
+		WriteLatencies(file, _areaPanels[area.first]);
+		file << " }";
+		first = false;
+	}
+	file << std::endl << "  }," << std::endl << "  \"by_panel\": {";
+	first = true;
+	for (const std::pair<const int, std::vector<double>>& panel : _panels) {
+		file << (first ? "" : ",") << std::endl << "    \"0x" << std::hex << std::setw(5) << std::setfill('0') << panel.first << std::dec << std::setfill(' ') << "\": ";
+		WriteLatencies(file, panel.second);
+		first = false;
+	}
+	file << std::endl << "  }" << std::endl << "}" << std::endl;
+	return file.good();
+}
+
+//Nearest rank percentiles
+void Benchmark::WriteLatencies(std::ostream& out, std::vector<double> samples)
+{
+	std::sort(samples.begin(), samples.end());
+	auto percentile = [&](int p) { return samples.size() == 0 ? 0 : samples[(samples.size() * p + 99) / 100 - 1]; };
+	out << "{ \"count\": " << samples.size() << ", \"p50\": " << percentile(50) << ", \"p95\": " << percentile(95) << ", \"p99\": " << percentile(99) <<
+		", \"max\": " << (samples.size() == 0 ? 0 : samples.back()) << " }";
+}
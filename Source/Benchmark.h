@@ -0,0 +1,66 @@
+#pragma once
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Generation times collected over a run of seeds (see Randomizer::BenchmarkWorlds), written out as JSON so that the speed of the generator can be
+//compared from one version to the next. Areas are timed in PuzzleList, and panels as they are written (see PanelWritten). The times of a world are
+//held back until AddWorld, and left out if the world fails (DiscardWorld). Shared by every generator taking part, including those on other threads.
+class Benchmark
+{
+public:
+	//Times an area from construction to destruction, along with the panels written on this thread in the meantime. Does nothing without a benchmark
+	class AreaTimer {
+	public:
+		AreaTimer(Benchmark* benchmark, const std::string& area) {
+			_benchmark = benchmark;
+			if (!_benchmark) return;
+			_area = area;
+			_start = _panelStart = std::chrono::steady_clock::now();
+			_current = this;
+		}
+		~AreaTimer() {
+			if (!_benchmark) return;
+			_current = nullptr;
+			_benchmark->AddArea(_area, Since(_start));
+		}
+
+	private:
+		friend class Benchmark;
+		Benchmark* _benchmark;
+		std::string _area;
+		std::chrono::steady_clock::time_point _start, _panelStart;
+	};
+
+	//Called by Generate::write. Times the panel from the one written before it on this thread (or from the start of the area), so the attempts thrown
+	//away and the work of special cases count towards the panel they led to. Panels set up without Generate::write aren't timed
+	static void PanelWritten(int panel);
+	void AddWorld(double milliseconds);
+	void DiscardWorld();
+	bool WriteJSON(const std::string& filename, const std::string& config);
+
+	static double Since(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+private:
+	struct PanelTime {
+		int panel;
+		std::string area;
+		double milliseconds;
+	};
+
+	void AddArea(const std::string& area, double milliseconds);
+	static void WriteLatencies(std::ostream& out, std::vector<double> samples);
+
+	static thread_local AreaTimer* _current; //Area being generated on this thread
+
+	std::vector<PanelTime> _newPanels; //Of the world being generated
+	std::vector<std::pair<std::string, double>> _newAreas;
+	std::map<int, std::vector<double>> _panels;
+	std::map<std::string, std::vector<double>> _areas, _areaPanels;
+	std::vector<double> _worlds, _allPanels;
+	std::mutex _lock;
+};
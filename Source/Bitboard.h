@@ -0,0 +1,120 @@
+#pragma once
+#include "Panel.h"
+#include <set>
+#include <vector>
+#include <bitset>
+#include <stdint.h>
+
+//Set of grid points stored as bits - one 64 bit word per column, with bit y set for the point (x, y). Panels are far smaller than 64x64, so this
+//covers every coordinate the generator uses. It has the same interface as std::set<Point> where the generator needs it and is iterated in the same
+//order (by x, then y), so it can stand in for one without changing which point a random pick lands on.
+class Bitboard
+{
+public:
+	static const int Size = 64;
+
+	Bitboard() { clear(); }
+	Bitboard(const std::set<Point>& points) { clear(); for (Point p : points) insert(p); }
+	Bitboard(const std::vector<Point>& points) { clear(); for (Point p : points) insert(p); }
+	operator std::set<Point>() const { return std::set<Point>(begin(), end()); }
+
+	class iterator {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Point value_type;
+		typedef ptrdiff_t difference_type;
+		typedef const Point* pointer;
+		typedef const Point& reference;
+
+		iterator(const Bitboard* board, int x, uint64_t bits) { _board = board; _x = x; _bits = bits; advance(); }
+		Point operator*() const { return Point(_x, lowestBit(_bits)); }
+		iterator& operator++() { _bits &= _bits - 1; advance(); return *this; }
+		bool operator==(const iterator& other) const { return _x == other._x && _bits == other._bits; }
+		bool operator!=(const iterator& other) const { return !(*this == other); }
+
+	private:
+		void advance() {
+			while (_bits == 0 && ++_x < Size) _bits = _board->_columns[_x];
+			if (_bits == 0) _x = Size;
+		}
+		const Bitboard* _board;
+		int _x;
+		uint64_t _bits;
+	};
+	iterator begin() const { return iterator(this, 0, _columns[0]); }
+	iterator end() const { return iterator(this, Size, 0); }
+
+	bool insert(Point p) {
+		if (!inRange(p)) throw std::exception("Point out of range for a bitboard");
+		uint64_t bit = 1ull << p.second;
+		if (_columns[p.first] & bit) return false;
+		_columns[p.first] |= bit;
+		_size++;
+		return true;
+	}
+	size_t erase(Point p) {
+		if (!count(p)) return 0;
+		_columns[p.first] &= ~(1ull << p.second);
+		_size--;
+		return 1;
+	}
+	size_t count(Point p) const { return inRange(p) && (_columns[p.first] >> p.second & 1); }
+	size_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+	void clear() { for (int x = 0; x < Size; x++) _columns[x] = 0; _size = 0; }
+
+	//The point that iterating would reach after index others - a popcount per column, rather than stepping through the points one at a time
+	Point nth(size_t index) const {
+		for (int x = 0; x < Size; x++) {
+			size_t inColumn = std::bitset<64>(_columns[x]).count();
+			if (index >= inColumn) {
+				index -= inColumn;
+				continue;
+			}
+			uint64_t bits = _columns[x];
+			for (; index > 0; index--) bits &= bits - 1;
+			return Point(x, lowestBit(bits));
+		}
+		throw std::exception("Bitboard index out of range");
+	}
+
+	//Every point step away (horizontally or vertically) from a point on the board, plus the board itself. On pillars (pillarWidth > 0) the columns wrap around
+	Bitboard expand(int step, int pillarWidth) const {
+		Bitboard result = *this;
+		int width = pillarWidth ? pillarWidth : Size;
+		for (int x = 0; x < width; x++) {
+			if (!_columns[x]) continue;
+			result._columns[x] |= _columns[x] << step | _columns[x] >> step;
+			if (pillarWidth || x + step < Size) result._columns[(x + step) % width] |= _columns[x];
+			if (pillarWidth || x - step >= 0) result._columns[(x - step + width) % width] |= _columns[x];
+		}
+		result.recount();
+		return result;
+	}
+
+	Bitboard& operator|=(const Bitboard& other) { for (int x = 0; x < Size; x++) _columns[x] |= other._columns[x]; recount(); return *this; }
+	Bitboard& operator&=(const Bitboard& other) { for (int x = 0; x < Size; x++) _columns[x] &= other._columns[x]; recount(); return *this; }
+	Bitboard& erase(const Bitboard& other) { for (int x = 0; x < Size; x++) _columns[x] &= ~other._columns[x]; recount(); return *this; }
+	bool operator==(const Bitboard& other) const { for (int x = 0; x < Size; x++) if (_columns[x] != other._columns[x]) return false; return true; }
+	bool operator!=(const Bitboard& other) const { return !(*this == other); }
+
+	//Points on even or odd coordinates - e.g. parity(0, 0) are the intersections, parity(1, 1) the grid blocks
+	static Bitboard parity(int xParity, int yParity) {
+		Bitboard result;
+		uint64_t column = yParity ? 0xAAAAAAAAAAAAAAAAull : 0x5555555555555555ull;
+		for (int x = xParity; x < Size; x += 2) result._columns[x] = column;
+		result.recount();
+		return result;
+	}
+
+private:
+	static bool inRange(Point p) { return p.first >= 0 && p.first < Size && p.second >= 0 && p.second < Size; }
+	static int lowestBit(uint64_t bits) { return static_cast<int>(std::bitset<64>((bits & (~bits + 1)) - 1).count()); }
+	void recount() {
+		_size = 0;
+		for (int x = 0; x < Size; x++) _size += std::bitset<64>(_columns[x]).count();
+	}
+
+	uint64_t _columns[Size];
+	size_t _size;
+};
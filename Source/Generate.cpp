@@ -6,62 +6,69 @@
 #include "Randomizer.h"
 #include "MultiGenerate.h"
 #include "Special.h"
+#include "Solver.h"
+#include "JobPool.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <climits>
+#include <chrono>
 
 void Generate::generate(int id, int symbol, int amount) {
 	PuzzleSymbols symbols({ std::make_pair(symbol, amount) });
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2) });
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 void Generate::generate(int id, int symbol1, int amount1,  int symbol2, int amount2, int symbol3, int amount3) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3) });
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4) });
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5) });
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5, int symbol6, int amount6) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5), std::make_pair(symbol6, amount6) });
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5, int symbol6, int amount6, int symbol7, int amount7) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5), std::make_pair(symbol6, amount6), std::make_pair(symbol7, amount7) });
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5, int symbol6, int amount6, int symbol7, int amount7, int symbol8, int amount8) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5), std::make_pair(symbol6, amount6), std::make_pair(symbol7, amount7), std::make_pair(symbol8, amount8) });
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 void Generate::generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3, int symbol4, int amount4, int symbol5, int amount5, int symbol6, int amount6, int symbol7, int amount7, int symbol8, int amount8, int symbol9, int amount9) {
 	PuzzleSymbols symbols({ std::make_pair(symbol1, amount1), std::make_pair(symbol2, amount2), std::make_pair(symbol3, amount3), std::make_pair(symbol4, amount4),  std::make_pair(symbol5, amount5), std::make_pair(symbol6, amount6), std::make_pair(symbol7, amount7), std::make_pair(symbol8, amount8), std::make_pair(symbol9, amount9) });
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 void Generate::generate(int id, const std::vector<std::pair<int, int>>& symbolVec)
 {
 	PuzzleSymbols symbols(symbolVec);
-	while (!generate(id, symbols));
+	retry(id, [&](Generate& gen) { return gen.generate(id, symbols); });
 }
 
 //Generate puzzle with multiple solutions. id - id of the puzzle. gens - the generators that will be used to make solutions. symbolVec - pairs of symbols and amounts to use
 void Generate::generateMulti(int id, std::vector<std::shared_ptr<Generate>> gens, std::vector<std::pair<int, int>> symbolVec)
 {
-	MultiGenerate gen;
+	MultiGenerate gen(_random);
 	gen.splitStones = (id == 0x17C34); //Mountaintop
 	gen.generate(id, gens, symbolVec);
 	incrementProgress();
@@ -70,10 +77,10 @@ void Generate::generateMulti(int id, std::vector<std::shared_ptr<Generate>> gens
 //Generate puzzle with multiple solutions. id - id of the puzzle. numSolutions - the number of possible solutions. symbolVec - pairs of symbols and amounts to use
 void Generate::generateMulti(int id, int numSolutions, std::vector<std::pair<int, int>> symbolVec)
 {
-	MultiGenerate gen;
+	MultiGenerate gen(_random);
 	gen.splitStones = (id == 0x17C34); //Mountaintop
 	std::vector<std::shared_ptr<Generate>> gens;
-	for (; numSolutions > 0; numSolutions--) gens.push_back(std::make_shared<Generate>());
+	for (; numSolutions > 0; numSolutions--) gens.push_back(std::make_shared<Generate>(_random));
 	gen.generate(id, gens, symbolVec);
 	incrementProgress();
 }
@@ -86,18 +93,17 @@ std::vector<Point> Generate::_DISCONNECT = { Point(0, 2), Point(0, -2), Point(2,
 	Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0), Point(2, 2), Point(2, -2), Point(-2, -2), Point(-2, 2),
 	Point(0, 4), Point(0, -4), Point(4, 0), Point(-4, 0), //Used to make the discontiguous shapes
 };
-std::vector<Point> Generate::_SHAPEDIRECTIONS = { }; //This will eventually be set to one of the above lists
 
 //Make a maze puzzle. The maze will have one solution. id - id of the puzzle
 void Generate::generateMaze(int id) {
-	while (!generate_maze(id, 0, 0));
+	retry(id, [&](Generate& gen) { return gen.generate_maze(id, 0, 0); });
 }
 
 //Make a maze puzzle. The maze will have one solution. id - id of the puzzle. numStarts - how many starts to add (only one will be valid). numExits - how many exits to add. All will work
 //Setting numStarts or numExits to 0 will keep the starts/exits where they originally were, otherwise the starts/exits originally there will be removed and new ones randomly placed.
 void Generate::generateMaze(int id, int numStarts, int numExits)
 {
-	while (!generate_maze(id, numStarts, numExits));
+	retry(id, [&](Generate& gen) { return gen.generate_maze(id, numStarts, numExits); });
 }
 
 //Read in default panel data, such as dimensions, symmetry, starts/exits, etc. id - id of the puzzle
@@ -106,7 +112,7 @@ void Generate::initPanel(int id) {
 		_panel = std::make_shared<Panel>(id);
 	}
 	if (_width > 0 && _height > 0 && (_width != _panel->_width || _height != _panel->_height)) {
-		_panel->Resize(Point::pillarWidth ? _width - 1 : _width, _height);
+		_panel->Resize(_panel->_pillarWidth ? _width - 1 : _width, _height);
 	}
 	if (hasFlag(Config::FixBackground)) {
 		_panel->Resize(_panel->_width, _panel->_height); //This will force the panel to have to redraw the background
@@ -152,7 +158,7 @@ void Generate::initPanel(int id) {
 	for (int x = 1; x < _panel->_width; x += 2) {
 		for (int y = 1; y < _panel->_height; y += 2) {
 			if (!(hasFlag(Config::PreserveStructure) && (get(x, y) & Decoration::Empty) == Decoration::Empty))
-				_gridpos.emplace(Point(x, y));
+				_gridpos.insert(Point(x, y));
 		}
 	}
 	//Init the open positions available for symbols. Defaults to every grid block unless a custom openpos has been specified
@@ -223,6 +229,7 @@ void Generate::write(int id)
 	erase_path();
 
 	incrementProgress();
+	Benchmark::PanelWritten(id);
 
 	if (hasFlag(Config::ResetColors)) {
 		_panel->colorMode = Panel::ColorMode::Reset;
@@ -284,8 +291,9 @@ void Generate::write(int id)
 		_oneTimeRemove = 0;
 	}
 	//Manually advance seed by 1 each generation to prevent seeds "funneling" from repeated fails
-	Random::seed(_seed);
-	_seed = Random::rand();
+	_random->seed(_seed);
+	_seed = _random->rand();
+	_random->finishPanel(id);
 }
 
 //Reset all config flags and persistent settings, including width/height and symmetry.
@@ -332,6 +340,20 @@ void Generate::set_path(Point pos)
 	}
 }
 
+//Undo set_path, for backing up out of a dead end
+void Generate::unset_path(Point pos)
+{
+	_panel->_grid[pos.first][pos.second] = 0;
+	_path.erase(pos);
+	if (_panel->symmetry) {
+		_path1.erase(pos);
+		Point sp = get_sym_point(pos);
+		_panel->_grid[sp.first][sp.second] = 0;
+		_path.erase(sp);
+		_path2.erase(sp);
+	}
+}
+
 //Remove the path and all symbols from the grid. This does not affect starts/exits. If PreserveStructure is active, open gaps will be kept. If a custom grid is set, this will reset it back to the custom grid state.
 void Generate::clear()
 {
@@ -361,6 +383,86 @@ void Generate::resetVars() {
 	_splitPoints.clear();
 }
 
+//Runs attempt on this generator until it succeeds. With counter-based streams every attempt starts from the state the generator is in now, using the
+//stream for its index, so the attempts don't depend on each other. The first attempt runs in place, as do the rest when _parallelAttempts is 1 (going back
+//to the starting state after each failure). Otherwise up to _parallelAttempts of the remaining attempts run at once on copies of the generator, on a pool of
+//threads kept for this thread. Workers take the attempts in order and stop taking new ones once an attempt has succeeded, the attempts after it are cancelled,
+//and the successful one with the lowest index is kept. This gives the same puzzle however many run at once.
+void Generate::retry(int id, const std::function<bool(Generate&)>& attempt)
+{
+	if (_random->mode() != Random::Counter) {
+		while (!attempt(*this));
+		return;
+	}
+	if (!_panel) _panel = std::make_shared<Panel>(id);
+	const int firstAttempt = _random->nextAttempt(id);
+	_speculative = true;
+	const Generate start(*this);
+	const Panel startPanel(*_panel);
+	const Random startRandom(*_random);
+	auto restart = [&](int index) {
+		*this = start;
+		*_panel = startPanel;
+		*_random = startRandom;
+		_random->setAttempt(id, firstAttempt + index);
+	};
+	bool done = attempt(*this);
+	for (int index = 1; !done && _parallelAttempts <= 1; index++) {
+		restart(index);
+		done = attempt(*this);
+	}
+	if (!done) {
+		std::shared_ptr<Memory::Overlay> dryRun = Memory::GetDryRun();
+		std::atomic<int> next = 1, best = INT_MAX;
+		std::shared_ptr<Generate> result;
+		std::exception_ptr error;
+		std::mutex lock;
+		auto work = [&]() {
+			Memory::JoinDryRun(dryRun);
+			for (int index = next++; index < best; index = next++) {
+				std::shared_ptr<Generate> gen = std::make_shared<Generate>(start);
+				gen->_panel = std::make_shared<Panel>(startPanel);
+				gen->_random = std::make_shared<Random>(startRandom);
+				gen->_random->setAttempt(id, firstAttempt + index);
+				gen->solutionCounts = nullptr;
+				gen->_best = &best;
+				gen->_attemptIndex = index;
+				try {
+					if (!attempt(*gen)) continue;
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> guard(lock);
+					if (!error) error = std::current_exception();
+					best = -1;
+					break;
+				}
+				std::lock_guard<std::mutex> guard(lock);
+				if (index < best) {
+					best = index;
+					result = gen;
+				}
+			}
+			Memory::JoinDryRun(nullptr);
+		};
+		static thread_local JobPool pool;
+		pool.Clear();
+		for (int i = 0; i < _parallelAttempts; i++) pool.Add(work);
+		pool.Run(_parallelAttempts);
+		pool.Clear();
+		if (error) std::rethrow_exception(error);
+
+		//Continue from where the successful attempt left off
+		std::shared_ptr<Random> random = _random;
+		*this = *result;
+		*random = *result->_random;
+		_random = random;
+		_best = nullptr;
+	}
+	//Write it here (so it is recorded on this thread)
+	_speculative = false;
+	if (!hasFlag(Config::DisableWrite)) write(id);
+}
+
 //Place start and exits in central positions like in the treehouse
 void Generate::init_treehouse_layout()
 {
@@ -377,6 +479,7 @@ void Generate::init_treehouse_layout()
 //The algorithm works by generating a correct path, then extending lines off of it until the maze is filled.
 bool Generate::generate_maze(int id, int numStarts, int numExits)
 {
+	_random->startPanel(id);
 	initPanel(id);
 
 	if (numStarts > 0) place_start(numStarts);
@@ -407,10 +510,10 @@ bool Generate::generate_maze(int id, int numStarts, int numExits)
 			min((_panel->_width + _panel->_height) * 2, (_panel->_width / 2 + 1) * (_panel->_height / 2 + 1) * 4 / 5))) clear();
 	}
 	
-	std::set<Point> path = _path; //Backup
+	Bitboard path = _path; //Backup
 
 	//Extra false starts are tracked in a separate list so that the generator can make sure to extend each of them by a higher amount than usual.
-	std::set<Point> extraStarts;
+	Bitboard extraStarts;
 	for (Point pos : _starts) {
 		if (!_path.count(pos)) {
 			extraStarts.insert(pos);
@@ -421,12 +524,9 @@ bool Generate::generate_maze(int id, int numStarts, int numExits)
 	if (extraStarts.size() != (_panel->symmetry ? _starts.size() / 2 - 1 : _starts.size() - 1))
 		return false;
 
-	std::set<Point> check;
+	Bitboard check = _path;
+	check &= Bitboard::parity(0, 0); //Only extend off of the points at grid intersections.
 	std::vector<Point> deadEndH, deadEndV;
-	for (Point p : _path) {
-		if (p.first % 2 == 0 && p.second % 2 == 0)
-			check.insert(p); //Only extend off of the points at grid intersections.
-	}
 	while (check.size() > 0) {
 		//Pick a random extendable point and extend it for some randomly chosen amount of units.
 		Point randomPos = (extraStarts.size() > 0 ? pick_random(extraStarts) : pick_random(check));
@@ -434,7 +534,7 @@ bool Generate::generate_maze(int id, int numStarts, int numExits)
 		for (int i = (extraStarts.size() > 0 ? 7 : 1); i >= 0; i--) { //False starts are extended by up to 7 units. Other points are extended 1 unit at a time
 			std::vector<Point> validDir;
 			for (Point dir : _DIRECTIONS2) {
-				if (!off_edge(pos + dir) && get(pos + dir) == 0) {
+				if (!off_edge(wrap(pos + dir)) && get(wrap(pos + dir)) == 0) {
 					validDir.push_back(dir);
 				}
 			}
@@ -447,7 +547,7 @@ bool Generate::generate_maze(int id, int numStarts, int numExits)
 				if (_fullGaps && !_exits.count(pos) && !_starts.count(pos)) {
 					int countOpenRow = 0, countOpenColumn = 0;
 					for (Point dir2 : _DIRECTIONS1) {
-						if (!off_edge(pos + dir2) && get(pos + dir2) == PATH) {
+						if (!off_edge(wrap(pos + dir2)) && get(wrap(pos + dir2)) == PATH) {
 							if (dir2.first == 0) countOpenColumn++;
 							else countOpenRow++;
 						}
@@ -460,9 +560,9 @@ bool Generate::generate_maze(int id, int numStarts, int numExits)
 				break; //A dead end has been reached, extend a different point
 			}
 			Point dir = pick_random(validDir);
-			Point newPos = pos + dir;
+			Point newPos = wrap(pos + dir);
 			set_path(newPos);
-			set_path(pos + dir / 2);
+			set_path(wrap(pos + dir / 2));
 			check.insert(newPos);
 			pos = newPos;
 		}
@@ -479,7 +579,7 @@ bool Generate::generate_maze(int id, int numStarts, int numExits)
 						sp.second == y && y % 2 == 0 && abs(sp.first - x) <= 2 || abs(sp.first - x) == 1) {
 						set(x, y, PATH);
 					}
-					else if (Random::rand() % 2 == 0) {
+					else if (_random->rand() % 2 == 0) {
 						set(sp, PATH);
 					}
 					else {
@@ -497,27 +597,44 @@ bool Generate::generate_maze(int id, int numStarts, int numExits)
 	for (Point p : deadEndV) {
 		set(p, Decoration::Gap_Column);
 	}
-	_path = path; //Restore backup of the correct solution for testing purposes
-	std::vector<std::string> solution; //For debugging only
-	for (int y = 0; y < _panel->_height; y++) {
-		std::string row;
-		for (int x = 0; x < _panel->_width; x++) {
-			if (_path.count(Point(x, y))) {
-				row += "xx";
-			}
-			else row += "    ";
-		}
-		solution.push_back(row);
+	//A maze should have one way through, but the symmetry or the extra starts and exits can open up another one
+	if (!legacy() || _verify || solutionCounts) {
+		auto begin = std::chrono::steady_clock::now();
+		int solutions = Solver(_panel).count(2);
+		if (solutionCounts) solutionCounts->push_back({ id, solutions, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count() });
+		if (solutions > 1 && (!legacy() || _verify)) return false;
 	}
-	if (!hasFlag(Config::DisableWrite)) write(id);
+	_path = path; //Restore backup of the correct solution for testing purposes
+	TRACE_PATH("generate_maze", _panel->id, _panel->_width, _panel->_height, [&](int x, int y) { return _path.count(Point(x, y)); });
+	if (!hasFlag(Config::DisableWrite) && !_speculative) write(id);
 	return true;
 }
 
+//Gap the segments leading to pos, so that an exit put there can't be reached. Returns false (leaving the panel as it was) if pos is on the solution or is
+//a start, or if the solver can't show that the line doesn't get there
+bool Generate::cut_off(Point pos)
+{
+	if (legacy() && !_verify) return true;
+	if (_path.count(pos) || _starts.count(pos)) return false;
+	std::vector<Point> gapped;
+	for (Point dir : _DIRECTIONS1) {
+		Point p = wrap(pos + dir);
+		if (off_edge(p) || get(p) != PATH) continue;
+		set(p, _fullGaps ? OPEN : p.first % 2 == 0 ? Decoration::Gap_Column : Decoration::Gap_Row);
+		gapped.push_back(p);
+	}
+	if (Solver(_panel, _starts, { pos }).solve() == Solver::Unsolvable) return true;
+	for (Point p : gapped) set(p, PATH);
+	return false;
+}
+
 //The primary generation function. id - id of the puzzle. symbols - a structure representing the amount and types of each symbol to add to the puzzle
 //The algorithm works by making a random path and then adding the chosen symbols to the grid in such a way that they will be satisfied by the path.
 //if at some point the generator fails to add a symbol while still making the solution correct, the function returns false and must be called again.
 bool Generate::generate(int id, PuzzleSymbols symbols)
 {
+	Profiler::Timer timer(profiler.get(), id);
+	_random->startPanel(id);
 	initPanel(id);
 
 	//Multiple erasers are forced to be separate by default. This is because combining them causes unpredictable and inconsistent behavior. 
@@ -532,7 +649,7 @@ bool Generate::generate(int id, PuzzleSymbols symbols)
 	if (symbols.getNum(Decoration::Dot) >= _panel->get_num_grid_points() - 2)
 		_parity = (_panel->get_parity() + (
 			!symbols.any(Decoration::Start) ? get_parity(pick_random(_starts)) :
-			!symbols.any(Decoration::Exit) ? get_parity(pick_random(_exits)) : Random::rand() % 2)) % 2;
+			!symbols.any(Decoration::Exit) ? get_parity(pick_random(_exits)) : _random->rand() % 2)) % 2;
 	else _parity = -1; //-1 indicates a non-full dot puzzle
 
 	if (symbols.any(Decoration::Start)) place_start(symbols.getNum(Decoration::Start));
@@ -542,33 +659,48 @@ bool Generate::generate(int id, PuzzleSymbols symbols)
 	if (customPath.size() == 0) {
 		int fails = 0;
 		while (!generate_path(symbols)) {
-			if (fails++ > 20) return false; //It gets several chances to make a path so that the whole init process doesn't have to be repeated so many times
+			if (fails++ > 20 || cancelled()) return timer.lap(Profiler::Path, false); //It gets several chances to make a path so that the whole init process doesn't have to be repeated so many times
 		}
 	}
 	else _path = customPath;
+	timer.lap(Profiler::Path);
+	if (cancelled()) return false;
 
-	std::vector<std::string> solution; //For debugging only
-	for (int y = 0; y < _panel->_height; y++) {
-		std::string row;
-		for (int x = 0; x < _panel->_width; x++) {
-			if (get(x, y) == PATH) {
-				row += "xx";
-			}
-			else row += "    ";
-		}
-		solution.push_back(row);
-	}
+	TRACE_PATH("generate", _panel->id, _panel->_width, _panel->_height, [&](int x, int y) { return get(x, y) == PATH; });
 
 	//Attempt to add the symbols
-	if (!place_all_symbols(symbols))
+	if (!place_all_symbols(symbols, timer) || cancelled())
 		return false;
 
-	if (!hasFlag(Config::DisableWrite)) write(id);
+	//Unknown means the solver ran out of steps, which doesn't make the panel wrong
+	if (_verify && Solver(_panel, _starts, _exits).solve() == Solver::Unsolvable)
+		return timer.lap(Profiler::Verify, false);
+	timer.lap(Profiler::Verify);
+
+	if (_maxDifficulty > 0 && !in_difficulty_band(id))
+		return timer.lap(Profiler::Difficulty, false);
+	timer.lap(Profiler::Difficulty);
+
+	if (!hasFlag(Config::DisableWrite) && !_speculative) write(id);
 	return true;
 }
 
+//Whether the panel's difficulty is in the band set with setDifficulty. Once a panel has had MaxDifficultyAttempts attempts any difficulty is taken,
+//so a band that the symbols can't reach doesn't stall the generator
+bool Generate::in_difficulty_band(int id)
+{
+	int attempt = (_random->mode() == Random::Counter ? _random->nextAttempt(id) : ++_difficultyAttempts[id]);
+	if (attempt > MaxDifficultyAttempts) return true;
+	Solver solver(_panel, _starts, _exits);
+	int solutions = solver.explore();
+	if (solutions == 0) return true; //Left to setVerify
+	if (solutions == -1) return false; //Too much searching to measure, which is harder than a band is meant for
+	double difficulty = solver.stats().difficulty();
+	return difficulty >= _minDifficulty && difficulty <= _maxDifficulty;
+}
+
 //Place the provided symbols onto the puzzle. symbols - a structure describing types and amounts of symbols to add.
-bool Generate::place_all_symbols(PuzzleSymbols & symbols)
+bool Generate::place_all_symbols(PuzzleSymbols & symbols, Profiler::Timer& timer)
 {
 	std::vector<int> eraseSymbols;
 	std::vector<int> eraserColors;
@@ -576,14 +708,14 @@ bool Generate::place_all_symbols(PuzzleSymbols & symbols)
 	for (std::pair<int, int> s : symbols[Decoration::Eraser]) {
 		for (int i = 0; i < s.second; i++) {
 			eraserColors.push_back(s.first & 0xf);
-			eraseSymbols.push_back(hasFlag(Config::FalseParity) ? Decoration::Dot_Intersection : symbols.popRandomSymbol());
+			eraseSymbols.push_back(hasFlag(Config::FalseParity) ? Decoration::Dot_Intersection : symbols.popRandomSymbol(*_random));
 		}
 	}
 
 	//Symbols are placed in stages according to their type
 	//In each of these loops, s.first is the symbol and s.second is the amount of it to add
 
-	_SHAPEDIRECTIONS = (hasFlag(Config::DisconnectShapes) ? _DISCONNECT : _DIRECTIONS2);
+	_shapeDirections = (hasFlag(Config::DisconnectShapes) ? _DISCONNECT : _DIRECTIONS2);
 	int numShapes = 0, numRotate = 0, numNegative = 0;
 	std::vector<int> colors, negativeColors;
 	for (std::pair<int, int> s : symbols[Decoration::Poly]) {
@@ -600,26 +732,34 @@ bool Generate::place_all_symbols(PuzzleSymbols & symbols)
 		}
 	}
 	if (numShapes > 0 && !place_shapes(colors, negativeColors, numShapes, numRotate, numNegative) || numShapes == 0 && numNegative > 0)
-		return false;
+		return timer.lap(Profiler::Shapes, false);
+	timer.lap(Profiler::Shapes);
 
 	_stoneTypes = static_cast<int>(symbols[Decoration::Stone].size());
 	_bisect = true; //This flag helps the generator prevent making two adjacent regions of stones the same color
 	for (std::pair<int, int> s : symbols[Decoration::Stone]) if (!place_stones(s.first & 0xf, s.second))
-		return false;
+		return timer.lap(Profiler::Stones, false);
+	timer.lap(Profiler::Stones);
 	for (std::pair<int, int> s : symbols[Decoration::Triangle]) if (!place_triangles(s.first & 0xf, s.second, s.first >> 16))
-		return false;
+		return timer.lap(Profiler::Triangles, false);
+	timer.lap(Profiler::Triangles);
 	for (std::pair<int, int> s : symbols[Decoration::Arrow]) if (!place_arrows(s.first & 0xf, s.second, s.first >> 12))
-		return false;
+		return timer.lap(Profiler::Arrows, false);
+	timer.lap(Profiler::Arrows);
 	for (std::pair<int, int> s : symbols[Decoration::Star]) if (!place_stars(s.first & 0xf, s.second))
-		return false;
+		return timer.lap(Profiler::Stars, false);
 	if (symbols.style == Panel::Style::HAS_STARS && hasFlag(Generate::Config::TreehouseLayout) && !checkStarZigzag(_panel))
-		return false;
+		return timer.lap(Profiler::Stars, false);
+	timer.lap(Profiler::Stars);
 	if (eraserColors.size() > 0 && !place_erasers(eraserColors, eraseSymbols))
-		return false;
+		return timer.lap(Profiler::Erasers, false);
+	timer.lap(Profiler::Erasers);
 	for (std::pair<int, int> s : symbols[Decoration::Dot]) if (!place_dots(s.second, (s.first & 0xf), (s.first & ~0xf) == Decoration::Dot_Intersection))
-		return false;
+		return timer.lap(Profiler::Dots, false);
+	timer.lap(Profiler::Dots);
 	for (std::pair<int, int> s : symbols[Decoration::Gap]) if (!place_gaps(s.second))
-		return false;
+		return timer.lap(Profiler::Gaps, false);
+	timer.lap(Profiler::Gaps);
 	return true;
 }
 
@@ -668,7 +808,7 @@ bool Generate::generate_path(PuzzleSymbols & symbols)
 
 	if (symbols.style == Panel::Style::HAS_SHAPERS) {
 		if (hasFlag(Config::SplitShapes)) {
-			return generate_path_regions(symbols.getNum(Decoration::Poly) + 1);
+			return generate_path_regions(symbols.getNum(Decoration::Poly) + 1, hasFlag(Config::SmallShapes) ? 1 : 2); //Not just room for monominoes
 		}
 		return generate_path_length(_panel->get_num_grid_points() / 2);
 	}
@@ -677,6 +817,8 @@ bool Generate::generate_path(PuzzleSymbols & symbols)
 }
 
 //Generate a random path with the provided minimum length.
+//With sequential streams this is a random walk that gives up after 20 blocked moves in a row, as in earlier versions. Otherwise it is a search that backs up
+//out of dead ends (see extend_path), so it only fails if there is no such path from the chosen start to the chosen exit or the search takes too long.
 bool Generate::generate_path_length(int minLength, int maxLength)
 {
 	int fails = 0;
@@ -685,25 +827,84 @@ bool Generate::generate_path_length(int minLength, int maxLength)
 	if (off_edge(pos) || off_edge(exit))
 		return false;
 	set_path(pos);
+	if (!legacy()) {
+		int budget = _panel->get_num_grid_points() * 50;
+		return extend_path(pos, exit, minLength, maxLength, budget);
+	}
 	while (pos != exit) {
 		if (fails++ > 20)
 			return false;
 		Point dir = pick_random(_DIRECTIONS2);
-		Point newPos = pos + dir;
-		if (off_edge(newPos) || get(newPos) != 0 || get(pos + dir / 2) != 0
+		Point newPos = wrap(pos + dir);
+		if (off_edge(newPos) || get(newPos) != 0 || get(wrap(pos + dir / 2)) != 0
 			|| newPos == exit && _path.size() / 2 + 2 < minLength) continue;
 		if (_panel->symmetry && (off_edge(get_sym_point(newPos)) || newPos == get_sym_point(newPos)))
 			continue;
 		set_path(newPos);
-		set_path(pos + dir / 2);
+		set_path(wrap(pos + dir / 2));
 		pos = newPos;
 		fails = 0;
 	}
 	return _path.size() / 2 + 1 >= minLength && _path.size() / 2 + 1 <= maxLength;
 }
 
-//Generate a path with the provided number of regions.
-bool Generate::generate_path_regions(int minRegions)
+//Extend the path from pos until it reaches exit with a length between minLength and maxLength (measured as in generate_path_length), trying the
+//directions in a random order and backing up when a branch fails. A branch is cut off as soon as the exit can't be reached from it, or can't be
+//reached with a length in range. budget is the number of moves that may still be tried.
+bool Generate::extend_path(Point pos, Point exit, int minLength, int maxLength, int& budget)
+{
+	int length = static_cast<int>(_path.size()) / 2 + 1;
+	if (pos == exit) return length >= minLength && length <= maxLength;
+	if (budget-- <= 0) return false;
+
+	//Search the free points that can still be reached, and how far away the exit is
+	std::vector<Point> layer = { pos }, next;
+	Bitboard seen;
+	seen.insert(pos);
+	int reachable = 0, distance = -1;
+	for (int steps = 1; layer.size() > 0; steps++) {
+		next.clear();
+		for (Point p : layer) {
+			for (Point dir : _DIRECTIONS2) {
+				if (!can_extend_path(p, dir) || !seen.insert(wrap(p + dir))) continue;
+				if (wrap(p + dir) == exit) distance = (distance == -1 ? steps : distance);
+				else next.push_back(wrap(p + dir));
+				reachable++;
+			}
+		}
+		layer.swap(next);
+	}
+	//Each move adds at least one to the length, or up to two with symmetry (the symmetric line grows too)
+	if (distance == -1 || length + distance > maxLength || length + reachable * (_panel->symmetry ? 2 : 1) < minLength)
+		return false;
+
+	std::vector<Point> directions = _DIRECTIONS2;
+	for (int i = static_cast<int>(directions.size()) - 1; i > 0; i--) std::swap(directions[i], directions[_random->rand() % (i + 1)]);
+	for (Point dir : directions) {
+		if (!can_extend_path(pos, dir)) continue;
+		Point newPos = wrap(pos + dir);
+		set_path(newPos);
+		set_path(wrap(pos + dir / 2));
+		if (extend_path(newPos, exit, minLength, maxLength, budget)) return true;
+		unset_path(wrap(pos + dir / 2));
+		unset_path(newPos);
+		if (budget <= 0) return false;
+	}
+	return false;
+}
+
+//Whether the path can go from pos to pos + dir - the same checks the random walk in generate_path_length makes (other than the length)
+bool Generate::can_extend_path(Point pos, Point dir)
+{
+	Point newPos = wrap(pos + dir);
+	if (off_edge(newPos) || get(newPos) != 0 || get(wrap(pos + dir / 2)) != 0) return false;
+	return !(_panel->symmetry && (off_edge(get_sym_point(newPos)) || newPos == get_sym_point(newPos)));
+}
+
+//Generate a path with the provided number of regions, of at least minSize blocks each.
+//With sequential streams the regions are estimated from how often the path leaves the edge, as in earlier versions, and their sizes aren't checked.
+//Otherwise the exact size of every region is kept up to date as each segment is laid (see RegionMap::Splits), and only regions big enough are counted.
+bool Generate::generate_path_regions(int minRegions, int minSize)
 {
 	int fails = 0;
 	int regions = 1;
@@ -711,18 +912,31 @@ bool Generate::generate_path_regions(int minRegions)
 	Point exit = adjust_point(pick_random(_exits));
 	if (off_edge(pos) || off_edge(exit)) return false;
 	set_path(pos);
+	if (!legacy()) {
+		label_regions();
+		regions = 0;
+		for (int i = 0; i < _regions.numRegions(); i++) if (_regions.members(i).size() >= minSize) regions++;
+	}
 	while (pos != exit) {
 		if (fails++ > 20)
 			return false;
 		Point dir = pick_random(_DIRECTIONS2);
-		Point newPos = pos + dir;
-		if (off_edge(newPos) || get(newPos) != 0 || get(pos + dir / 2) != 0
+		Point newPos = wrap(pos + dir);
+		if (off_edge(newPos) || get(newPos) != 0 || get(wrap(pos + dir / 2)) != 0
 			|| newPos == exit && regions < minRegions)
 			continue;
 		if (_panel->symmetry && (off_edge(get_sym_point(newPos)) || newPos == get_sym_point(newPos))) continue;
 		set_path(newPos);
-		set_path(pos + dir / 2);
-		if (!on_edge(newPos) && on_edge(pos)) {
+		set_path(wrap(pos + dir / 2));
+		if (!legacy()) {
+			std::vector<Point> edges = { wrap(pos + dir / 2) };
+			if (_panel->symmetry && get_sym_point(edges[0]) != edges[0]) edges.push_back(get_sym_point(edges[0]));
+			std::vector<int> before, after;
+			RegionMap::Splits(_panel->_grid, _panel->_width, _panel->_height, _panel->_pillarWidth, edges, &before, &after);
+			for (int size : before) if (size >= minSize) regions--;
+			for (int size : after) if (size >= minSize) regions++;
+		}
+		else if (!on_edge(newPos) && on_edge(pos)) {
 			regions++;
 			if (_panel->symmetry) regions++;
 		}
@@ -740,43 +954,37 @@ bool Generate::generate_longest_path()
 	if (off_edge(pos) || off_edge(exit)) return false;
 	Point block(-10, -10);
 	if (hasFlag(Config::FalseParity)) { //If false parity, one dot must be left uncovered
-		if (get_parity(pos + exit) == _panel->get_parity())
+		if (get_parity(wrap(pos + exit)) == _panel->get_parity())
 			return false;
-		block = Point(Random::rand() % (_panel->_width / 2 + 1) * 2, Random::rand() % (_panel->_height / 2 + 1) * 2);
+		block = wrap(Point(_random->rand() % (_panel->_width / 2 + 1) * 2, _random->rand() % (_panel->_height / 2 + 1) * 2));
 		while (pos == block || exit == block) {
-			block = Point(Random::rand() % (_panel->_width / 2 + 1) * 2, Random::rand() % (_panel->_height / 2 + 1) * 2);
+			block = wrap(Point(_random->rand() % (_panel->_width / 2 + 1) * 2, _random->rand() % (_panel->_height / 2 + 1) * 2));
 		}
 		set_path(block);
 	}
-	else if (get_parity(pos + exit) != _panel->get_parity())
+	else if (get_parity(wrap(pos + exit)) != _panel->get_parity())
 		return false;
+	if (!legacy() && !_panel->symmetry) {
+		if (!off_edge(block)) unset_path(block);
+		return generate_covering_path(pos, exit, block);
+	}
 	int fails = 0;
 	int reqLength = _panel->get_num_grid_points() + static_cast<int>(_path.size()) / 2;
 	bool centerFlag = !on_edge(pos);
 	set_path(pos);
 	while (pos != exit && !(_panel->symmetry && get_sym_point(pos) == exit)) {
-		std::vector<std::string> solution; //For debugging only
-		for (int y = 0; y < _panel->_height; y++) {
-			std::string row;
-			for (int x = 0; x < _panel->_width; x++) {
-				if (get(x, y) == PATH) {
-					row += "xx";
-				}
-				else row += "    ";
-			}
-			solution.push_back(row);
-		}
+		TRACE_PATH("generate_longest_path", _panel->id, _panel->_width, _panel->_height, [&](int x, int y) { return get(x, y) == PATH; });
 		if (fails++ > 20)
 			return false;
 		Point dir = pick_random(_DIRECTIONS2);
 		for (Point checkDir : _DIRECTIONS2) {
-			Point check = pos + checkDir;
+			Point check = wrap(pos + checkDir);
 			if (off_edge(check) || get(check) != 0)
 				continue;
 			if (check == exit) continue;
 			int open = 0;
 			for (Point checkDir2 : _DIRECTIONS2) {
-				if (!off_edge(check + checkDir2) && get(check + checkDir2) == 0) {
+				if (!off_edge(wrap(check + checkDir2)) && get(wrap(check + checkDir2)) == 0) {
 					if (++open >= 2) break;
 				}
 			}
@@ -785,20 +993,20 @@ bool Generate::generate_longest_path()
 				break;
 			}
 		}
-		Point newPos = pos + dir;
+		Point newPos = wrap(pos + dir);
 		//Various checks to see if going this direction will lead to any issues 
-		if (off_edge(newPos) || get(newPos) != 0 || get(pos + dir / 2) != 0
+		if (off_edge(newPos) || get(newPos) != 0 || get(wrap(pos + dir / 2)) != 0
 			|| newPos == exit && _path.size() / 2 + 3 < reqLength ||
 			_panel->symmetry && get_sym_point(newPos) == exit && _path.size() / 2 + 3 < reqLength) continue;
 		if (_panel->symmetry && (off_edge(get_sym_point(newPos)) || newPos == get_sym_point(newPos))) continue;
-		if (on_edge(newPos) && Point::pillarWidth == 0 && _panel->symmetry != Panel::Symmetry::Horizontal && newPos + dir != block && (off_edge(newPos + dir) || get(newPos + dir) != 0)) {
-			if (centerFlag && off_edge(newPos + dir)) {
+		if (on_edge(newPos) && _panel->_pillarWidth == 0 && _panel->symmetry != Panel::Symmetry::Horizontal && wrap(newPos + dir) != block && (off_edge(wrap(newPos + dir)) || get(wrap(newPos + dir)) != 0)) {
+			if (centerFlag && off_edge(wrap(newPos + dir))) {
 				centerFlag = false;
 			}
 			else {
 				int open = 0;
 				for (Point checkDir : _DIRECTIONS2) {
-					if (!off_edge(newPos + checkDir) && get(newPos + checkDir) == 0) {
+					if (!off_edge(wrap(newPos + checkDir)) && get(wrap(newPos + checkDir)) == 0) {
 						if (++open >= 2) break;
 					}
 				}
@@ -806,7 +1014,7 @@ bool Generate::generate_longest_path()
 			}
 		}
 		set_path(newPos);
-		set_path(pos + dir / 2);
+		set_path(wrap(pos + dir / 2));
 		pos = newPos;
 		fails = 0;
 	}
@@ -815,6 +1023,84 @@ bool Generate::generate_longest_path()
 	return _path.size() / 2 + 1 == reqLength;
 }
 
+//Build a path from pos to exit through every free intersection except block, for panels without symmetry (used by generate_longest_path when the
+//streams aren't sequential). The path is grown from pos, going to the neighbour with the fewest free neighbours of its own. When it gets stuck, or
+//once everything is covered, it is rearranged with backbite moves: the end joins up with a neighbour already on the path, and the part of the path
+//after that neighbour is reversed, giving a new end. This keeps going until the path covers everything and ends at the exit.
+bool Generate::generate_covering_path(Point pos, Point exit, Point block)
+{
+	std::vector<Point> points;
+	std::map<Point, int> vertex;
+	for (int x = 0; x < _panel->_width; x += 2) {
+		for (int y = 0; y < _panel->_height; y += 2) {
+			if (Point(x, y) == block || get(x, y) != 0 && Point(x, y) != pos) continue;
+			vertex[Point(x, y)] = static_cast<int>(points.size());
+			points.push_back(Point(x, y));
+		}
+	}
+	if (!vertex.count(pos) || !vertex.count(exit)) return false;
+	std::vector<std::vector<int>> neighbors(points.size());
+	for (int i = 0; i < points.size(); i++) {
+		for (Point dir : _DIRECTIONS2) {
+			Point next = wrap(points[i] + dir);
+			if (off_edge(next) || !vertex.count(next) || get(wrap(points[i] + dir / 2)) != 0) continue;
+			neighbors[i].push_back(vertex[next]);
+		}
+	}
+
+	int start = vertex[pos], end = vertex[exit];
+	std::vector<int> path, index(points.size()); //index - position of each point in the path, -1 if it isn't on it yet
+	//Moving one end around doesn't always lead to a given exit, so after a while the path is started over
+	for (int round = 0; path.size() < points.size() || path.back() != end; round++) {
+		if (round == 10) return false;
+		path = { start };
+		std::fill(index.begin(), index.end(), -1);
+		index[start] = 0;
+		for (int steps = _panel->get_num_grid_points() * 20; steps > 0 && (path.size() < points.size() || path.back() != end); steps--) {
+			int last = path.back();
+			//Grow the path while it can (the exit is saved for last, as the path can't go anywhere from it)
+			int best = -1, bestOpen = INT_MAX, ties = 0;
+			for (int next : neighbors[last]) {
+				if (index[next] != -1 || next == end && path.size() + 1 < points.size()) continue;
+				int open = 0;
+				for (int n : neighbors[next]) if (index[n] == -1) open++;
+				if (open < bestOpen) {
+					best = next;
+					bestOpen = open;
+					ties = 1;
+				}
+				else if (open == bestOpen && _random->rand() % ++ties == 0) best = next;
+			}
+			//Otherwise backbite, or go to the exit early if that is the only way out
+			std::vector<int> options;
+			for (int n : neighbors[last]) if (index[n] != -1 && index[n] + 2 < path.size()) options.push_back(n);
+			if (best == -1 && options.size() == 0 && index[end] == -1 && std::find(neighbors[last].begin(), neighbors[last].end(), end) != neighbors[last].end())
+				best = end;
+			if (best != -1) {
+				index[best] = static_cast<int>(path.size());
+				path.push_back(best);
+				continue;
+			}
+			if (options.size() == 0) break;
+			int i = index[options[_random->rand() % options.size()]];
+			std::reverse(path.begin() + i + 1, path.end());
+			for (int j = i + 1; j < path.size(); j++) index[path[j]] = j;
+		}
+	}
+
+	for (int i = 0; i < path.size(); i++) {
+		set_path(points[path[i]]);
+		if (i == 0) continue;
+		for (Point dir : _DIRECTIONS2) {
+			if (wrap(points[path[i - 1]] + dir) == points[path[i]]) {
+				set_path(wrap(points[path[i - 1]] + dir / 2));
+				break;
+			}
+		}
+	}
+	return true;
+}
+
 //Generate path that passes through all of the hitPoints in order
 bool Generate::generate_special_path()
 {
@@ -831,9 +1117,9 @@ bool Generate::generate_special_path()
 	while (pos != exit) {
 		std::vector<Point> validDir;
 		for (Point dir : _DIRECTIONS2) {
-			Point newPos = pos + dir;
+			Point newPos = wrap(pos + dir);
 			if (off_edge(newPos)) continue;
-			Point connectPos = pos + dir / 2;
+			Point connectPos = wrap(pos + dir / 2);
 			//Go through the hit point if passing next to it
 			if (get(connectPos) == PATH && hitIndex < hitPoints.size() && connectPos == hitPoints[hitIndex]) {
 				validDir = { dir };
@@ -844,7 +1130,7 @@ bool Generate::generate_special_path()
 			if (_panel->symmetry && newPos == get_sym_point(newPos)) continue;
 			bool fail = false;
 			for (Point dir : _DIRECTIONS1) {
-				if (!off_edge(newPos + dir) && get(newPos + dir) == PATH && newPos + dir != hitPoints[hitIndex]) {
+				if (!off_edge(wrap(newPos + dir)) && get(wrap(newPos + dir)) == PATH && wrap(newPos + dir) != hitPoints[hitIndex]) {
 					fail = true;
 					break;
 				}
@@ -855,9 +1141,9 @@ bool Generate::generate_special_path()
 		if (validDir.size() == 0)
 			return false;
 		Point dir = pick_random(validDir);
-		set_path(pos + dir);
-		set_path(pos + dir / 2);
-		pos = pos + dir;
+		set_path(wrap(pos + dir));
+		set_path(wrap(pos + dir / 2));
+		pos = wrap(pos + dir);
 	}
 	return hitIndex == hitPoints.size() && _path.size() >= minLength;
 }
@@ -879,12 +1165,12 @@ Point Generate::adjust_point(Point pos) {
 	if (pos.first % 2 != 0) {
 		if (get(pos) != 0) return { -10, -10 };
 		set_path(pos);
-		return Point(pos.first - 1 + Random::rand() % 2 * 2, pos.second);
+		return wrap(Point(pos.first - 1 + _random->rand() % 2 * 2, pos.second));
 	}
 	if (pos.second % 2 != 0) {
 		if (get(pos) != 0) return { -10, -10 };
 		set_path(pos);
-		return Point(pos.first, pos.second - 1 + Random::rand() % 2 * 2);
+		return Point(pos.first, pos.second - 1 + _random->rand() % 2 * 2);
 	}
 	if (_panel->symmetry && _exits.count(pos) && !_exits.count(get_sym_point(pos))) return { -10, -10 };
 	return pos;
@@ -892,25 +1178,13 @@ Point Generate::adjust_point(Point pos) {
 
 //Get the set of points in region containing the point (pos)
 std::set<Point> Generate::get_region(Point pos) {
-	std::set<Point> region;
-	std::vector<Point> check;
-	check.push_back(pos);
-	region.insert(pos);
-	while (check.size() > 0) {
-		Point p = check[check.size() - 1];
-		check.pop_back();
-		for (Point dir : _DIRECTIONS1) {
-			Point p1 = p + dir;
-			if (on_edge(p1)) continue;
-			if (get(p1) == PATH || get(p1) == OPEN) continue;
-			Point p2 = p + dir * 2;
-			if ((get(p2) & Decoration::Empty) == Decoration::Empty) continue;
-			if (region.insert(p2).second) {
-				check.push_back(p2);
-			}
-		}
-	}
-	return region;
+	return RegionMap::Flood(_panel->_grid, _panel->_width, _panel->_height, _panel->_pillarWidth, pos);
+}
+
+//Label the regions of the current path into _regions, for the symbol placement functions. Needs to be called again whenever the path changes
+void Generate::label_regions() {
+	_regions.build(_panel->_grid, _panel->_width, _panel->_height, _panel->_pillarWidth);
+	_regions.countSymbols();
 }
 
 //Get all the symbols in the region containing including the point (pos)
@@ -933,9 +1207,9 @@ bool Generate::place_start(int amount)
 	_starts.clear();
 	_panel->_startpoints.clear();
 	while (amount > 0) {
-		Point pos = Point(Random::rand() % (_panel->_width / 2 + 1) * 2, Random::rand() % (_panel->_height / 2 + 1) * 2);
+		Point pos = wrap(Point(_random->rand() % (_panel->_width / 2 + 1) * 2, _random->rand() % (_panel->_height / 2 + 1) * 2));
 		if (hasFlag(Config::StartEdgeOnly))
-		switch (Random::rand() % 4) {
+		switch (_random->rand() % 4) {
 		case 0: pos.first = 0; break;
 		case 1: pos.second = 0; break;
 		case 2: pos.first = _panel->_width - 1; break;
@@ -947,12 +1221,12 @@ bool Generate::place_start(int amount)
 		//Highly discourage putting start points adjacent
 		bool adjacent = false;
 		for (Point dir : _DIRECTIONS2) {
-			if (!off_edge(pos + dir) && get(pos + dir) == Decoration::Start) {
+			if (!off_edge(wrap(pos + dir)) && get(wrap(pos + dir)) == Decoration::Start) {
 				adjacent = true;
 				break;
 			}
 		}
-		if (adjacent && Random::rand() % 10 > 0) continue;
+		if (adjacent && _random->rand() % 10 > 0) continue;
 		_starts.insert(pos);
 		_panel->SetGridSymbol(pos.first, pos.second, Decoration::Start, Decoration::Color::None);
 		amount--;
@@ -971,8 +1245,8 @@ bool Generate::place_exit(int amount)
 	_exits.clear();
 	_panel->_endpoints.clear();
 	while (amount > 0) {
-		Point pos = Point(Random::rand() % (_panel->_width / 2 + 1) * 2, Random::rand() % (_panel->_height / 2 + 1) * 2);
-		switch (Random::rand() % 4) {
+		Point pos = wrap(Point(_random->rand() % (_panel->_width / 2 + 1) * 2, _random->rand() % (_panel->_height / 2 + 1) * 2));
+		switch (_random->rand() % 4) {
 		case 0: pos.first = 0; break;
 		case 1: pos.second = 0; break;
 		case 2: pos.first = _panel->_width - 1; break;
@@ -985,7 +1259,7 @@ bool Generate::place_exit(int amount)
 		//Prevent putting exit points adjacent
 		bool adjacent = false;
 		for (Point dir : _8DIRECTIONS2) {
-			if (!off_edge(pos + dir) && get(pos + dir) == Decoration::Exit) {
+			if (!off_edge(wrap(pos + dir)) && get(wrap(pos + dir)) == Decoration::Exit) {
 				adjacent = true;
 				break;
 			}
@@ -1009,7 +1283,7 @@ bool Generate::can_place_gap(Point pos) {
 	if (pos.first == 0 || pos.second == 0) {
 		if (hasFlag(Config::FullGaps)) return false;
 	}
-	else if (Random::rand() % 2 == 0) return false; //Encourages gaps on outside border
+	else if (_random->rand() % 2 == 0) return false; //Encourages gaps on outside border
 	//Prevent putting a gap on top of a start/end point
 	if (_starts.count(pos) || _exits.count(pos))
 		return false;
@@ -1021,11 +1295,11 @@ bool Generate::can_place_gap(Point pos) {
 	if (_panel->symmetry == Panel::Symmetry::FlipXY && (pos.first - pos.second == 1 || pos.first - pos.second == -1)) return false;
 	if (hasFlag(Config::FullGaps)) { //Prevent forming dead ends with open gaps
 		std::vector<Point> checkPoints = (pos.first % 2 == 0 ? std::vector<Point>({ Point(pos.first, pos.second - 1), Point(pos.first, pos.second + 1) })
-			: std::vector<Point>({ Point(pos.first - 1, pos.second), Point(pos.first + 1, pos.second) }));
+			: std::vector<Point>({ wrap(Point(pos.first - 1, pos.second)), wrap(Point(pos.first + 1, pos.second)) }));
 		for (Point check : checkPoints) {
 			int valid = 4;
 			for (Point dir : _DIRECTIONS1) {
-				Point p = check + dir;
+				Point p = wrap(check + dir);
 				if (off_edge(p) || get(p) & GAP || get(p) == OPEN) {
 					if (--valid <= 2) {
 						return false;
@@ -1039,11 +1313,11 @@ bool Generate::can_place_gap(Point pos) {
 
 //Place the given amount of gaps radomly around the puzzle
 bool Generate::place_gaps(int amount) {
-	std::set<Point> open;
+	Bitboard open;
 	for (int y = 0; y < _panel->_height; y++) {
 		for (int x = (y + 1) % 2; x < _panel->_width; x += 2) {
 			if (get(x, y) == 0 && (!_fullGaps || !on_edge(Point(x, y)))) {
-				open.emplace(Point(x, y));
+				open.insert(Point(x, y));
 			}
 		}
 	}
@@ -1082,20 +1356,20 @@ bool Generate::can_place_dot(Point pos, bool intersectionOnly) {
 		return false; //Prevent sharing of dots between symmetry lines
 	if (hasFlag(Config::DisableDotIntersection)) return true;
 	for (Point dir : _8DIRECTIONS1) {
-		Point p = pos + dir;
+		Point p = wrap(pos + dir);
 		if (!off_edge(p) && (get(p) & DOT)) {
 			//Don't allow adjacent dots
 			if (dir.first == 0 || dir.second == 0)
 				return false;
 			//Allow diagonally adjacent placement some of the time
-			if (Random::rand() % 2 > 0)
+			if (_random->rand() % 2 > 0)
 				return false;
 		}
 	}
 	//Allow 2-space horizontal/vertical placement some of the time
-	if (Random::rand() % (intersectionOnly ? 10 : 5) > 0) {
+	if (_random->rand() % (intersectionOnly ? 10 : 5) > 0) {
 		for (Point dir : _DIRECTIONS2) {
-			Point p = pos + dir;
+			Point p = wrap(pos + dir);
 			if (!off_edge(p) && (get(p) & DOT)) {
 				return false;
 			}
@@ -1124,26 +1398,12 @@ bool Generate::place_dots(int amount, int color, bool intersectionOnly) {
 		color = IntersectionFlags::DOT_IS_ORANGE;
 	else color = 0;
 
-	std::set<Point> open = (color == 0 ? _path : color == IntersectionFlags::DOT_IS_BLUE ? _path1 : _path2);
+	Bitboard open = (color == 0 ? _path : color == IntersectionFlags::DOT_IS_BLUE ? _path1 : _path2);
 	for (Point p : _starts) open.erase(p);
 	for (Point p : _exits) open.erase(p);
 	for (Point p : blockPos) open.erase(p);
-	if (intersectionOnly) {
-		std::set<Point> intersections;
-		for (Point p : open) {
-			if (p.first % 2 == 0 && p.second % 2 == 0)
-				intersections.insert(p);
-		}
-		open = intersections;
-	}
-	if (hasFlag(Config::DisableDotIntersection)) {
-		std::set<Point> intersections;
-		for (Point p : open) {
-			if (p.first % 2 != 0 || p.second % 2 != 0)
-				intersections.insert(p);
-		}
-		open = intersections;
-	}
+	if (intersectionOnly) open &= Bitboard::parity(0, 0);
+	if (hasFlag(Config::DisableDotIntersection)) open.erase(Bitboard::parity(0, 0));
 
 	while (amount > 0) {
 		if (open.size() == 0)
@@ -1154,7 +1414,7 @@ bool Generate::place_dots(int amount, int color, bool intersectionOnly) {
 		int symbol = (pos.first & 1) == 1 ? Decoration::Dot_Row : (pos.second & 1) == 1 ? Decoration::Dot_Column : Decoration::Dot_Intersection;
 		set(pos, symbol | color);
 		for (Point dir : _DIRECTIONS1) {
-			open.erase(pos + dir);
+			open.erase(wrap(pos + dir));
 		} //If symmetry, set a flag to break the point symmetric to the dot
 		if (_panel->symmetry) {
 			Point sp = get_sym_point(pos);
@@ -1162,7 +1422,7 @@ bool Generate::place_dots(int amount, int color, bool intersectionOnly) {
 			if (symbol != Decoration::Dot_Intersection) set(sp, symbol & ~Decoration::Dot);
 			open.erase(sp);
 			for (Point dir : _DIRECTIONS1) {
-				open.erase(sp + dir);
+				open.erase(wrap(sp + dir));
 			}
 		}
 		amount--;
@@ -1171,9 +1431,12 @@ bool Generate::place_dots(int amount, int color, bool intersectionOnly) {
 }
 
 //Check if a stone can be placed at pos.
-bool Generate::can_place_stone(const std::set<Point>& region, int color)
+bool Generate::can_place_stone(Point pos, int color)
 {
-	for (Point p : region) {
+	const RegionMap::ColorCounts* counts = _regions.counts(pos);
+	if (counts && (counts->stones[color] == 0 || counts->stones[color] == counts->numStones)) return counts->stones[color] == counts->numStones;
+	//Stones of several colors (left by erasers) - the first one decides
+	for (Point p : _regions.region(pos)) {
 		int sym = get(p);
 		if (get_symbol_type(sym) == Decoration::Stone) return (sym & 0xf) == color;
 	}
@@ -1182,8 +1445,9 @@ bool Generate::can_place_stone(const std::set<Point>& region, int color)
 
 //Place the given amount of stones with the given color
 bool Generate::place_stones(int color, int amount) {
-	std::set<Point> open = _openpos;
-	std::set<Point> open2; //Used to store open points removed from the first pass, to make sure a stone is put in every non-adjacent region
+	label_regions();
+	Bitboard open = _openpos;
+	Bitboard open2; //Used to store open points removed from the first pass, to make sure a stone is put in every non-adjacent region
 	int passCount = 0;
 	int originalAmount = amount;
 	while (amount > 0) {
@@ -1200,8 +1464,8 @@ bool Generate::place_stones(int color, int amount) {
 			continue;
 		}
 		Point pos = pick_random(open);
-		std::set<Point> region = get_region(pos);
-		if (!can_place_stone(region, color)) {
+		const std::vector<Point>& region = _regions.region(pos);
+		if (!can_place_stone(pos, color)) {
 			for (Point p : region) {
 				open.erase(p);
 			}
@@ -1224,9 +1488,9 @@ bool Generate::place_stones(int color, int amount) {
 			} //Remove adjacent regions from the open list
 			for (Point p : region) {
 				for (Point dir : _8DIRECTIONS2) {
-					Point pos2 = p + dir;
-					if (open.count(pos2) && !region.count(pos2)) {
-						for (Point P : get_region(pos2)) {
+					Point pos2 = wrap(p + dir);
+					if (open.count(pos2) && !_regions.same(pos, pos2)) {
+						for (Point P : _regions.region(pos2)) {
 							open.erase(P);
 						}
 					}
@@ -1245,8 +1509,8 @@ bool Generate::place_stones(int color, int amount) {
 
 //Generate a random shape. region - the region of points to choose from; points chosen will be removed.
 //bufferRegion - points that may be chosen twice due to overlapping shapes; points will be removed from here before points in region.
-//maxSize - the maximum size of the generated shape. Whether the points can be contiguous or not is determined by local variable _SHAPEDIRECTIONS
-Shape Generate::generate_shape(std::set<Point>& region, std::set<Point>& bufferRegion, Point pos, int maxSize)
+//maxSize - the maximum size of the generated shape. Whether the points can be contiguous or not is determined by _shapeDirections
+Shape Generate::generate_shape(Bitboard& region, Bitboard& bufferRegion, Point pos, int maxSize)
 {
 	Shape shape;
 	shape.insert(pos);
@@ -1256,8 +1520,8 @@ Shape Generate::generate_shape(std::set<Point>& region, std::set<Point>& bufferR
 		pos = pick_random(shape);
 		int i = 0;
 		for (; i < 10; i++) {
-			Point dir = pick_random(_SHAPEDIRECTIONS);
-			Point p = pos + dir;
+			Point dir = pick_random(_shapeDirections);
+			Point p = wrap(pos + dir);
 			if (region.count(p) && !shape.count(p)) {
 				shape.insert(p);
 				if (!bufferRegion.erase(p))
@@ -1271,24 +1535,123 @@ Shape Generate::generate_shape(std::set<Point>& region, std::set<Point>& bufferR
 	return shape;
 }
 
+//Split part.region into at most part.maxShapes shapes of up to part.maxSize blocks that fit in a 4x4 box, covering the blocks in part.bufferRegion twice
+//(by two different shapes). Unlike generate_shape followed by sticking the leftovers onto shapes, this is an exhaustive search: it only fails if there
+//is no such split, or if the search runs out of budget. On success the shapes are in part.shapes and the regions are empty, otherwise part is unchanged.
+//The search covers the first block left in the region with each shape, growing the shapes by Redelmeier's method so no shape is tried twice, and
+//prefers shapes of part.targetSize blocks.
+bool Generate::partition_region(ShapePartition& part)
+{
+	if (part.region.size() == 0) return true;
+	if (part.maxShapes == 0 || part.budget <= 0 || static_cast<int>(part.region.size() + part.bufferRegion.size()) > part.maxShapes * part.maxSize)
+		return false;
+	Point pos = *part.region.begin();
+	if (!part.bufferRegion.erase(pos)) part.region.erase(pos);
+	Shape shape = { pos };
+	Bitboard seen;
+	seen.insert(pos);
+	std::vector<Point> untried;
+	for (Point dir : _shapeDirections) {
+		Point p = wrap(pos + dir);
+		if (part.region.count(p) && seen.insert(p)) untried.push_back(p);
+	}
+	if (grow_partition_shape(part, shape, untried, seen)) return true;
+	if (part.region.count(pos)) part.bufferRegion.insert(pos);
+	else part.region.insert(pos);
+	return false;
+}
+
+//Try every way of finishing a shape for partition_region. untried are the blocks the shape may grow into next, seen those that have been considered for it
+bool Generate::grow_partition_shape(ShapePartition& part, Shape& shape, std::vector<Point> untried, const Bitboard& seen)
+{
+	if (part.budget-- <= 0) return false;
+	//Bigger shapes are tried before closing this one if it is below the target size, and after it otherwise. Closing a shape is also put off
+	//depending on its weight in the catalog, so shapes that come up too often are only used when the others don't work out
+	bool closeFirst = shape.size() >= part.targetSize && _random->rand() % Polyomino::MaxWeight < Polyomino::Get(Polyomino::FromShape(shape, _panel->_pillarWidth)).weight;
+	for (int pass = 0; pass < 2; pass++) {
+		if (pass == (closeFirst ? 0 : 1)) {
+			part.shapes.push_back(shape);
+			part.maxShapes--;
+			bool result = partition_region(part);
+			part.maxShapes++;
+			if (result) return true;
+			part.shapes.pop_back();
+			continue;
+		}
+		if (shape.size() >= part.maxSize) continue;
+		std::vector<Point> options = untried;
+		while (options.size() > 0) {
+			int i = _random->rand() % options.size();
+			Point pos = options[i];
+			options.erase(options.begin() + i);
+			if (!fits_shape_box(shape, pos)) continue;
+			//Blocks tried at this level aren't tried again further down, so the same shape isn't reached in different orders
+			std::vector<Point> next = options;
+			Bitboard nextSeen = seen;
+			for (Point dir : _shapeDirections) {
+				Point p = wrap(pos + dir);
+				if (part.region.count(p) && !shape.count(p) && nextSeen.insert(p)) next.push_back(p);
+			}
+			if (!part.bufferRegion.erase(pos)) part.region.erase(pos);
+			shape.insert(pos);
+			if (grow_partition_shape(part, shape, next, nextSeen)) return true;
+			shape.erase(pos);
+			if (part.region.count(pos)) part.bufferRegion.insert(pos);
+			else part.region.insert(pos);
+			if (part.budget <= 0) return false;
+		}
+	}
+	return false;
+}
+
+//Whether the shape still fits in a 4x4 box with pos added (horizontally, this is only checked off pillars - make_shape_symbol handles the wrapping)
+bool Generate::fits_shape_box(const Shape& shape, Point pos)
+{
+	int minx = pos.first, maxx = pos.first, miny = pos.second, maxy = pos.second;
+	for (Point p : shape) {
+		if (p.first < minx) minx = p.first;
+		if (p.first > maxx) maxx = p.first;
+		if (p.second < miny) miny = p.second;
+		if (p.second > maxy) maxy = p.second;
+	}
+	return (_panel->_pillarWidth || maxx - minx <= 6) && maxy - miny <= 6;
+}
+
 //Get the integer representing the shape, accounting for whether it is rotated or negative. -1 rotation means a random rotation, depth is for controlling recursion and should be set to 0
-int Generate::make_shape_symbol(Shape shape, bool rotated, bool negative, int rotation, int depth)
+//Returns 0 if the shape can't be used. weighed - the shape came from partition_region, which has already drawn against its weight
+int Generate::make_shape_symbol(Shape shape, bool rotated, bool negative, int rotation, int depth, bool weighed)
 {
 	int symbol = static_cast<int>(Decoration::Poly);
+	if (!legacy()) { //Catalog lookups
+		int mask = Polyomino::FromShape(shape, _panel->_pillarWidth);
+		if (mask == 0) return 0;
+		const Polyomino::Entry& entry = Polyomino::Get(mask);
+		if (!weighed && _random->rand() % Polyomino::MaxWeight >= entry.weight) return 0;
+		if (rotated) {
+			if (rotation == -1) {
+				if (entry.symmetric) return 0;
+				rotation = _random->rand() % 4;
+			}
+			symbol |= Decoration::Can_Rotate;
+			mask = entry.rotations[rotation];
+		}
+		if (negative) symbol |= Decoration::Negative;
+		return symbol | mask << 16;
+	}
 	if (rotated) {
 		if (rotation == -1) {
 			if (make_shape_symbol(shape, rotated, negative, 0, depth + 1) == make_shape_symbol(shape, rotated, negative, 1, depth + 1))
 				return 0; //Check to make sure the shape is not the same when rotated
-			rotation = Random::rand() % 4;
+			rotation = _random->rand() % 4;
 		}
 		symbol |= Decoration::Can_Rotate;
 		Shape newShape; //Rotate shape points according to rotation
 		for (Point p : shape) {
 			switch (rotation) {
 			case 0: newShape.insert(p); break;
-			case 1: newShape.emplace(Point(p.second, -p.first)); break;
-			case 2: newShape.emplace(Point(-p.second, p.first)); break;
-			case 3: newShape.emplace(Point(-p.first, -p.second)); break;
+			case 1: newShape.emplace(wrap(Point(p.second, -p.first))); break;
+			case 2: newShape.emplace(wrap(Point(-p.second, p.first))); break;
+			case 3: newShape.emplace(wrap(Point(-p.first, -p.second))); break;
 			}
 		}
 		shape = newShape;
@@ -1302,20 +1665,17 @@ int Generate::make_shape_symbol(Shape shape, bool rotated, bool negative, int ro
 		if (p.second > ymax) ymax = p.second;
 	}
 	if (xmax - xmin > 6 || ymax - ymin > 6) { //Shapes cannot be more than 4 in width and height
-		if (Point::pillarWidth == 0 || ymax - ymin > 6 || depth > Point::pillarWidth / 2) return 0;
+		if (_panel->_pillarWidth == 0 || ymax - ymin > 6 || depth > _panel->_pillarWidth / 2) return 0;
 		Shape newShape;
-		for (Point p : shape) newShape.insert({ (p.first - xmax + Point::pillarWidth) % Point::pillarWidth, p.second });
+		for (Point p : shape) newShape.insert({ (p.first - xmax + _panel->_pillarWidth) % _panel->_pillarWidth, p.second });
 		return make_shape_symbol(newShape, rotated, negative, rotation, depth + 1);
 	}
 	//Translate to the corner and set bit flags (16 bits, 1 where a shape block is present)
 	for (Point p : shape) {
 		symbol |= (1 << ((p.first - xmin) / 2 + (ymax  - p.second) * 2)) << 16;
 	}
-	if (Random::rand() % 4 > 0) { //The generator makes a certain type of symbol way too often (2x2 square with another square attached), this makes it much less frequent
-		int type = symbol >> 16;
-		if (type == 0x0331 || type == 0x0332 || type == 0x0037 || type == 0x0067 || type == 0x0133 || type == 0x0233 || type == 0x0073 || type == 0x0076)
-			return 0;
-	}
+	if (_random->rand() % Polyomino::MaxWeight >= Polyomino::Get(symbol >> 16).weight) //Makes shapes the generator comes up with too often less frequent
+		return 0;
 	return symbol;
 }
 
@@ -1324,7 +1684,8 @@ int Generate::make_shape_symbol(Shape shape, bool rotated, bool negative, int ro
 //numRotated - how many rotated shapes, numNegative - how many negative shapes
 bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<int>& negativeColors, int amount, int numRotated, int numNegative)
 {
-	std::set<Point> open = _openpos;
+	label_regions();
+	Bitboard open = _openpos;
 	int shapeSize = hasFlag(Config::SmallShapes) ? 2 : hasFlag(Config::BigShapes) ? amount == 1 ? 8 : 6 : 4;
 	int targetArea = amount * shapeSize * 7 / 8; //Average size must be at least 7/8 of the target size
 	if (amount * shapeSize > _panel->get_num_grid_blocks()) targetArea = _panel->get_num_grid_blocks();
@@ -1335,17 +1696,17 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 	}
 	int totalArea = 0;
 	int minx = _panel->_width, miny = _panel->_height, maxx = 0, maxy = 0;
-	int colorIndex = Random::rand() % colors.size();
-	int colorIndexN = Random::rand() % (negativeColors.size() + 1);
+	int colorIndex = _random->rand() % colors.size();
+	int colorIndexN = _random->rand() % (negativeColors.size() + 1);
 	bool shapesCanceled = false, shapesCombined = false, flatShapes = true;
 	if (amount == 1) shapesCombined = true;
 	while (amount > 0) {
 		if (open.size() == 0)
 			return false;
 		Point pos = pick_random(open);
-		std::set<Point> region = get_region(pos);
-		std::set<Point> bufferRegion;
-		std::set<Point> open2; //Open points for just that region
+		Bitboard region = _regions.region(pos);
+		Bitboard bufferRegion;
+		Bitboard open2; //Open points for just that region
 		for (Point p : region) {
 			if (open.erase(p)) open2.insert(p);
 		}
@@ -1353,24 +1714,25 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 			targetArea != _panel->get_num_grid_blocks()) continue; //To prevent shapes from filling every grid point
 		std::vector<Shape> shapes;
 		std::vector<Shape> shapesN;
-		int numShapesN = min(Random::rand() % (numNegative + 1), static_cast<int>(region.size()) / 3); //Negative blocks may be at max 1/3 of the regular blocks
+		std::vector<Shape> weighed; //Shapes partition_region has already drawn against their weight
+		int numShapesN = min(_random->rand() % (numNegative + 1), static_cast<int>(region.size()) / 3); //Negative blocks may be at max 1/3 of the regular blocks
 		if (amount == 1) numShapesN = numNegative;
 		if (numShapesN) {
-			std::set<Point> regionN = _gridpos;
+			Bitboard regionN = _gridpos;
 			int maxSize = static_cast<int>(region.size()) - numShapesN * 3; //Max size of negative shapes
 			if (maxSize == 0) maxSize = 1;
 			for (int i = 0; i < numShapesN; i++) {
 				pos = pick_random(region);
 				//Try to pick a random point adjacent to a shape
 				for (int i = 0; i < 10; i++) {
-					Point p = pos + pick_random(_SHAPEDIRECTIONS);
+					Point p = wrap(pos + pick_random(_shapeDirections));
 					if (regionN.count(p) && !region.count(p)) {
 						pos = p;
 						break;
 					}
 				}
 				if (!regionN.count(pos)) return false;
-				Shape shape = generate_shape(regionN, pos, min(Random::rand() % 3 + 1, maxSize));
+				Shape shape = generate_shape(regionN, pos, min(_random->rand() % 3 + 1, maxSize));
 				shapesN.push_back(shape);
 				for (Point p : shape) {
 					if (region.count(p)) bufferRegion.insert(p); //Buffer region stores overlap between shapes
@@ -1380,8 +1742,8 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 		}
 		int numShapes = static_cast<int>(region.size() + bufferRegion.size()) / (shapeSize + 1) + 1; //Pick a number of shapes to make. I tried different ones until I found something that made a good variety of shapes
 		if (numShapes == 1 && bufferRegion.size() > 0) numShapes++; //If there is any overlap, we need at least two shapes
-		if (numShapes < amount && region.size() > shapeSize && Random::rand() % 2 == 1) numShapes++; //Adds more variation to the shape sizes
-		if (region.size() <= shapeSize + 1 && bufferRegion.size() == 0 && Random::rand() % 2 == 1) numShapes = 1; //For more variation, sometimes make a bigger shape than the target if the size is close
+		if (numShapes < amount && region.size() > shapeSize && _random->rand() % 2 == 1) numShapes++; //Adds more variation to the shape sizes
+		if (region.size() <= shapeSize + 1 && bufferRegion.size() == 0 && _random->rand() % 2 == 1) numShapes = 1; //For more variation, sometimes make a bigger shape than the target if the size is close
 		if (hasFlag(Config::MountainFloorH)) {
 			if (region.size() < 19) continue;
 			numShapes = 6; //The big mountain floor puzzle on hard mode needs additional shapes since some combine
@@ -1396,8 +1758,8 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 			if (numNegative < 2 || hasFlag(Config::DisableCancelShapes)) continue;
 			//Make balancing shapes - Positive and negative will be switched so that code can be reused
 			balance = true;
-			std::set<Point> regionN = _gridpos;
-			numShapes = max(2, Random::rand() % numNegative + 1);			//Actually the negative shapes
+			Bitboard regionN = _gridpos;
+			numShapes = max(2, _random->rand() % numNegative + 1);			//Actually the negative shapes
 			numShapesN = min(amount, 1);		//Actually the positive shapes
 			if (numShapesN >= numShapes * 3 || numShapesN * 5 <= numShapes) continue;
 			shapes.clear();
@@ -1405,7 +1767,7 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 			region.clear();
 			bufferRegion.clear();
 			for (int i = 0; i < numShapesN; i++) {
-				Shape shape = generate_shape(regionN, pick_random(regionN), min(shapeSize + 1, numShapes * 2 / numShapesN + Random::rand() % 3 - 1));
+				Shape shape = generate_shape(regionN, pick_random(regionN), min(shapeSize + 1, numShapes * 2 / numShapesN + _random->rand() % 3 - 1));
 				shapesN.push_back(shape);
 				for (Point p : shape) {
 					region.insert(p);
@@ -1414,7 +1776,7 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 			shapesCanceled = true;
 			//Let the rest of the algorithm create the cancelling shapes
 		}
-		if (_panel->symmetry && numShapes == originalAmount && numShapes >= 3 && Point::pillarWidth == 0 && !region.count(Point((_panel->_width / 4) * 2 + 1, (_panel->_height / 4) * 2 + 1)))
+		if (_panel->symmetry && numShapes == originalAmount && numShapes >= 3 && _panel->_pillarWidth == 0 && !region.count(Point((_panel->_width / 4) * 2 + 1, (_panel->_height / 4) * 2 + 1)))
 			continue; //Prevent it from shoving all shapes to one side of symmetry
 		if ((_panel->symmetry == Panel::Symmetry::ParallelH || _panel->symmetry == Panel::Symmetry::ParallelV ||
 			_panel->symmetry == Panel::Symmetry::ParallelHFlip || _panel->symmetry == Panel::Symmetry::ParallelVFlip)
@@ -1427,9 +1789,19 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 			shapes.push_back(region);
 			region.clear();
 		}
+		else if (!legacy()) {
+			ShapePartition part = { region, bufferRegion, {}, numShapes, balance ? _random->rand() % 3 + 1 : shapeSize, shapeSize + 1, 20000 };
+			if (!partition_region(part)) continue; //The region can't be split up (or it took too long to find out)
+			for (Shape& shape : part.shapes) {
+				if (!balance && numShapesN) for (Shape s : shapesN) if (std::equal(shape.begin(), shape.end(), s.begin(), s.end())) return false; //Prevent unintentional in-group canceling
+				shapes.push_back(shape);
+			}
+			weighed = part.shapes;
+			region.clear();
+		}
 		else for (; numShapes > 0; numShapes--) {
 			if (region.size() == 0) break;
-			Shape shape = generate_shape(region, bufferRegion, pick_random(region), balance ? Random::rand() % 3 + 1 : shapeSize);
+			Shape shape = generate_shape(region, bufferRegion, pick_random(region), balance ? _random->rand() % 3 + 1 : shapeSize);
 			if (!balance && numShapesN) for (Shape s : shapesN) if (std::equal(shape.begin(), shape.end(), s.begin(), s.end())) return false; //Prevent unintentional in-group canceling
 			shapes.push_back(shape);
 		}
@@ -1441,7 +1813,7 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 				if (shape.size() > shapeSize || shape.count(pos) > 0) continue;
 				for (Point p : shape) {
 					for (Point dir : _DIRECTIONS2) {
-						if (pos + dir == p) {
+						if (wrap(pos + dir) == p) {
 							shape.insert(pos);
 							if (!bufferRegion.erase(pos))
 								region.erase(pos);
@@ -1469,7 +1841,7 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 				disconnect = true;
 				for (Point p : shape) {
 					for (Point dir : _DIRECTIONS2) {
-						if (shape.count(p + dir)) {
+						if (shape.count(wrap(p + dir))) {
 							disconnect = false;
 							break;
 						}
@@ -1488,7 +1860,8 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 			amount -= 2;
 		}
 		for (Shape& shape : shapes) {
-			int symbol = make_shape_symbol(shape, (numRotated-- > 0), (numShapes-- <= 0));
+			bool partitioned = std::find(weighed.begin(), weighed.end(), shape) != weighed.end();
+			int symbol = make_shape_symbol(shape, (numRotated-- > 0), (numShapes-- <= 0), partitioned);
 			if (symbol == 0)
 				return false;
 			if (!((symbol >> 16) == 0x000F || (symbol >> 16) == 0x1111))
@@ -1500,7 +1873,7 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 				pos = pick_random(open2);
 				bool pass = true;
 				for (Point dir : _8DIRECTIONS2) {
-					Point p = pos + dir;
+					Point p = wrap(pos + dir);
 					if (!off_edge(p) && get(p) & Decoration::Poly) {
 						pass = false;
 						break;
@@ -1516,7 +1889,7 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 			}
 			open2.erase(pos);
 			_openpos.erase(pos);
-			if (_panel->symmetry && Point::pillarWidth == 0 && originalAmount >= 3) {
+			if (_panel->symmetry && _panel->_pillarWidth == 0 && originalAmount >= 3) {
 				for (const Point& p : shape) {
 					if (p.first < minx) minx = p.first;
 					if (p.second < miny) miny = p.second;
@@ -1532,17 +1905,19 @@ bool Generate::place_shapes(const std::vector<int>& colors, const std::vector<in
 		originalAmount > 1 && flatShapes)
 		return false;
 	//If symmetry, make sure it didn't shove all the shapes to one side
-	if (_panel->symmetry && Point::pillarWidth == 0 && originalAmount >= 3 &&
+	if (_panel->symmetry && _panel->_pillarWidth == 0 && originalAmount >= 3 &&
 		(minx >= _panel->_width / 2 || maxx <= _panel->_width / 2 || miny >= _panel->_height / 2 || maxy <= _panel->_height / 2))
 		return false;
 	return true;
 }
 
 //Count the occurrence of the given symbol color in the given region (for the stars)
-int Generate::count_color(const std::set<Point>& region, int color)
+int Generate::count_color(Point pos, int color)
 {
+	const RegionMap::ColorCounts* counts = _regions.counts(pos);
+	if (counts) return min(counts->symbols[color], 3);
 	int count = 0;
-	for (Point p : region) {
+	for (Point p : _regions.region(pos)) {
 		int sym = get(p);
 		if (sym && (sym & 0xf) == color)
 			if (count++ == 2) return count;
@@ -1553,17 +1928,18 @@ int Generate::count_color(const std::set<Point>& region, int color)
 //Place the given amount of stars with the given color
 bool Generate::place_stars(int color, int amount)
 {
-	std::set<Point> open = _openpos;
+	label_regions();
+	Bitboard open = _openpos;
 	while (amount > 0) {
 		if (open.size() == 0)
 			return false;
 		Point pos = pick_random(open);
-		std::set<Point> region = get_region(pos);
-		std::set<Point> open2; //All of the open points in that region
+		const std::vector<Point>& region = _regions.region(pos);
+		Bitboard open2; //All of the open points in that region
 		for (Point p : region) {
 			if (open.erase(p)) open2.insert(p);
 		}
-		int count = count_color(region, color);
+		int count = count_color(pos, color);
 		if (count >= 2) continue; //Too many of that color
 		if (open2.size() + count < 2) continue; //Not enough space to get 2 of that color
 		if (count == 0 && amount == 1) continue; //If one star is left, it needs a pair
@@ -1584,9 +1960,11 @@ bool Generate::place_stars(int color, int amount)
 }
 
 //Check if there is a star in the given region
-bool Generate::has_star(const std::set<Point>& region, int color)
+bool Generate::has_star(Point pos, int color)
 {
-	for (Point p : region) {
+	const RegionMap::ColorCounts* counts = _regions.counts(pos);
+	if (counts) return counts->stars[color] > 0;
+	for (Point p : _regions.region(pos)) {
 		if (get(p) == (Decoration::Star | color)) return true;
 	}
 	return false;
@@ -1618,7 +1996,7 @@ bool Generate::place_triangles(int color, int amount, int targetCount)
 		set({ 1, 3 }, Decoration::Triangle | color | (count << 16));
 		_openpos.erase({ 1, 3 });
 	}
-	std::set<Point> open = _openpos;
+	Bitboard open = _openpos;
 	int count1 = 0, count2 = 0, count3 = 0;
 	while (amount > 0) {
 		if (open.size() == 0)
@@ -1633,7 +2011,7 @@ bool Generate::place_triangles(int color, int amount, int targetCount)
 		if (hasFlag(Config::TreehouseLayout) || _panel->id == 0x289E7) { //If the block is adjacent to a start or exit, don't place a triangle there
 			bool found = false;
 			for (Point dir : _DIRECTIONS1) {
-				if (_starts.count(pos + dir) || _exits.count(pos + dir)) {
+				if (_starts.count(wrap(pos + dir)) || _exits.count(wrap(pos + dir))) {
 					found = true;
 					break;
 				}
@@ -1641,15 +2019,15 @@ bool Generate::place_triangles(int color, int amount, int targetCount)
 			if (found) continue;
 		}
 		if (count == 1) {
-			if (!targetCount && count1 * 2 > count2 + count3 && Random::rand() % 2 == 0) continue;
+			if (!targetCount && count1 * 2 > count2 + count3 && _random->rand() % 2 == 0) continue;
 			count1++;
 		}
 		if (count == 2) {
-			if (!targetCount && count2 * 2 > count1 + count3 && Random::rand() % 2 == 0) continue;
+			if (!targetCount && count2 * 2 > count1 + count3 && _random->rand() % 2 == 0) continue;
 			count2++;
 		}
 		if (count == 3) {
-			if (!targetCount && count3 * 2 > count1 + count2 && Random::rand() % 2 == 0) continue;
+			if (!targetCount && count3 * 2 > count1 + count2 && _random->rand() % 2 == 0) continue;
 			count3++;
 		}
 		set(pos, Decoration::Triangle | color | (count << 16));
@@ -1664,7 +2042,7 @@ int Generate::count_sides(Point pos)
 {
 	int count = 0;
 	for (Point dir : _DIRECTIONS1) {
-		Point p = pos + dir;
+		Point p = wrap(pos + dir);
 		if (!off_edge(p) && get(p) == PATH) {
 			count++;
 		}
@@ -1676,23 +2054,23 @@ int Generate::count_sides(Point pos)
 //The color won't actually be reflected, ArrowRecolor must be used instead
 bool Generate::place_arrows(int color, int amount, int targetCount)
 {
-	std::set<Point> open = _openpos;
+	Bitboard open = _openpos;
 	while (amount > 0) {
 		if (open.size() == 0)
 			return false;
 		Point pos = pick_random(open);
 		open.erase(pos);
-		if (pos.first == _panel->_width / 2 || Point::pillarWidth > 0 && pos.first == _panel->_width / 2 - 1)
+		if (pos.first == _panel->_width / 2 || _panel->_pillarWidth > 0 && pos.first == _panel->_width / 2 - 1)
 			continue; //Because of a glitch where arrows in the center column won't draw right
 		int fails = 0;
 		while (fails++ < 20) { //Keep picking random directions until one works
-			int choice = (_parity == -1 ? Random::rand() % 8 : Random::rand() % 4);
+			int choice = (_parity == -1 ? _random->rand() % 8 : _random->rand() % 4);
 			Point dir = _8DIRECTIONS2[choice];
-			if (Point::pillarWidth > 0 && dir.second == 0) continue; //Sideways arrows on a pillar would wrap forever
+			if (_panel->_pillarWidth > 0 && dir.second == 0) continue; //Sideways arrows on a pillar would wrap forever
 			int count = count_crossings(pos, dir);
 			if (count == 0 || count > 3 || targetCount && count != targetCount) continue;
 			if (dir.first < 0 && count == (pos.first + 1) / 2 || dir.first > 0 && count == (_panel->_width - pos.first) / 2 ||
-				dir.second < 0 && count == (pos.second + 1) / 2 || dir.second > 0 && count == (_panel->_height - pos.second) / 2 && Random::rand() % 10 > 0)
+				dir.second < 0 && count == (pos.second + 1) / 2 || dir.second > 0 && count == (_panel->_height - pos.second) / 2 && _random->rand() % 10 > 0)
 				continue; //Make it so that there will be some possible edges that aren't passed, in the vast majority of cases
 			set(pos, Decoration::Arrow | color | (count << 12) | (choice << 16));
 			_openpos.erase(pos);
@@ -1706,11 +2084,11 @@ bool Generate::place_arrows(int color, int amount, int targetCount)
 //Count the number of times the given vector is passed through (for the arrows)
 int Generate::count_crossings(Point pos, Point dir)
 {
-	pos = pos + dir / 2;
+	pos = wrap(pos + dir / 2);
 	int count = 0;
 	while (!off_edge(pos)) {
 		if (get(pos) == PATH) count++;
-		pos = pos + dir;
+		pos = wrap(pos + dir);
 	}
 	return count;
 }
@@ -1718,7 +2096,8 @@ int Generate::count_crossings(Point pos, Point dir)
 //Place the given amount of erasers with the given colors. eraseSymbols are the symbols that were erased
 bool Generate::place_erasers(const std::vector<int>& colors, const std::vector<int>& eraseSymbols)
 {
-	std::set<Point> open = _openpos;
+	label_regions();
+	Bitboard open = _openpos;
 	if (_panel->id == 0x288FC && hasFlag(Generate::Config::DisableWrite)) open.erase({ 5, 5 }); //For the puzzle in the cave with a pillar in middle
 	int amount = static_cast<int>(colors.size());
 	while (amount > 0) {
@@ -1727,30 +2106,30 @@ bool Generate::place_erasers(const std::vector<int>& colors, const std::vector<i
 		int toErase = eraseSymbols[amount - 1];
 		int color = colors[amount - 1];
 		Point pos = pick_random(open);
-		std::set<Point> region = get_region(pos);
-		std::set<Point> open2;
+		const std::vector<Point>& region = _regions.region(pos);
+		Bitboard open2;
 		for (Point p : region) {
 			if (open.erase(p)) open2.insert(p);
 		}
 		if (_splitPoints.size() > 0) { //Make sure this is one of the split point regions
 			bool found = false;
 			for (Point p : _splitPoints) {
-				if (region.count(p)) {
+				if (std::binary_search(region.begin(), region.end(), p)) {
 					found = true;
 					break;
 				}
 			}
 			if (!found) continue;
 		}
-		if (_panel->id == 0x288FC && hasFlag(Generate::Config::DisableWrite) && !region.count({ 5, 5 })) continue; //For the puzzle in the cave with a pillar in middle
+		if (_panel->id == 0x288FC && hasFlag(Generate::Config::DisableWrite) && !std::binary_search(region.begin(), region.end(), Point(5, 5))) continue; //For the puzzle in the cave with a pillar in middle
 		if (hasFlag(Config::MakeStonesUnsolvable)) {
-			std::set<Point> valid;
+			Bitboard valid;
 			for (Point p : open2) {
 				//Try to make a checkerboard pattern with the stones
-				if (!off_edge(p + Point(2, 2)) && get(p + Point(2, 2)) == toErase && get(p + Point(0, 2)) != 0 && get(p + Point(0, 2)) != toErase && get(p + Point(2, 0)) != 0 && get(p + Point(2, 0)) != toErase ||
-					!off_edge(p + Point(-2, 2)) && get(p + Point(-2, 2)) == toErase && get(p + Point(0, 2)) != 0 && get(p + Point(0, 2)) != toErase && get(p + Point(-2, 0)) != 0 && get(p + Point(-2, 0)) != toErase ||
-					!off_edge(p + Point(2, -2)) && get(p + Point(2, -2)) == toErase && get(p + Point(0, -2)) != 0 && get(p + Point(0, -2)) != toErase && get(p + Point(2, 0)) != 0 && get(p + Point(2, 0)) != toErase ||
-					!off_edge(p + Point(-2, -2)) && get(p + Point(-2, -2)) == toErase && get(p + Point(0, -2)) != 0 && get(p + Point(0, -2)) != toErase && get(p + Point(-2, 0)) != 0 && get(p + Point(-2, 0)) != toErase)
+				if (!off_edge(wrap(p + Point(2, 2))) && get(wrap(p + Point(2, 2))) == toErase && get(wrap(p + Point(0, 2))) != 0 && get(wrap(p + Point(0, 2))) != toErase && get(wrap(p + Point(2, 0))) != 0 && get(wrap(p + Point(2, 0))) != toErase ||
+					!off_edge(wrap(p + Point(-2, 2))) && get(wrap(p + Point(-2, 2))) == toErase && get(wrap(p + Point(0, 2))) != 0 && get(wrap(p + Point(0, 2))) != toErase && get(wrap(p + Point(-2, 0))) != 0 && get(wrap(p + Point(-2, 0))) != toErase ||
+					!off_edge(wrap(p + Point(2, -2))) && get(wrap(p + Point(2, -2))) == toErase && get(wrap(p + Point(0, -2))) != 0 && get(wrap(p + Point(0, -2))) != toErase && get(wrap(p + Point(2, 0))) != 0 && get(wrap(p + Point(2, 0))) != toErase ||
+					!off_edge(wrap(p + Point(-2, -2))) && get(wrap(p + Point(-2, -2))) == toErase && get(wrap(p + Point(0, -2))) != 0 && get(wrap(p + Point(0, -2))) != toErase && get(wrap(p + Point(-2, 0))) != 0 && get(wrap(p + Point(-2, 0))) != toErase)
 					valid.insert(p);
 			}
 			open2 = valid;
@@ -1758,10 +2137,10 @@ bool Generate::place_erasers(const std::vector<int>& colors, const std::vector<i
 		if ((open2.size() == 0 || _splitPoints.size() == 0 && open2.size() == 1) && !(toErase & Decoration::Dot)) continue;
 		bool canPlace = false;
 		if (get_symbol_type(toErase) == Decoration::Stone) {
-			canPlace = !can_place_stone(region, (toErase & 0xf));
+			canPlace = !can_place_stone(pos, (toErase & 0xf));
 		}
 		else if (get_symbol_type(toErase) == Decoration::Star) {
-			canPlace = (count_color(region, (toErase & 0xf)) + (color == (toErase & 0xf) ? 1 : 0) != 1);
+			canPlace = (count_color(pos, (toErase & 0xf)) + (color == (toErase & 0xf) ? 1 : 0) != 1);
 		}
 		else canPlace = true;
 		if (!canPlace) continue;
@@ -1770,11 +2149,11 @@ bool Generate::place_erasers(const std::vector<int>& colors, const std::vector<i
 			set(pos, toErase);
 		}
 		else if (toErase & Decoration::Dot) { //Find an open edge to put the dot on
-			std::set<Point> openEdge;
+			Bitboard openEdge;
 			for (Point p : region) {
 				for (Point dir : _8DIRECTIONS1) {
 					if (toErase == Decoration::Dot_Intersection && (dir.first == 0 || dir.second == 0)) continue;
-					Point p2 = p + dir;
+					Point p2 = wrap(p + dir);
 					if (get(p2) == 0 && (hasFlag(Config::FalseParity) || can_place_dot(p2, false))) {
 						openEdge.insert(p2);
 					}
@@ -1794,13 +2173,13 @@ bool Generate::place_erasers(const std::vector<int>& colors, const std::vector<i
 		else if (get_symbol_type(toErase) == Decoration::Poly) {
 			int symbol = 0; //Make a random shape to cancel
 			while (symbol == 0) {
-				std::set<Point> area = _gridpos;
+				Bitboard area = _gridpos;
 				int shapeSize;
-				if ((toErase & Decoration::Negative) || hasFlag(Config::SmallShapes)) shapeSize = Random::rand() % 3 + 1;
+				if ((toErase & Decoration::Negative) || hasFlag(Config::SmallShapes)) shapeSize = _random->rand() % 3 + 1;
 				else {
-					shapeSize = Random::rand() % 5 + 1;
+					shapeSize = _random->rand() % 5 + 1;
 					if (shapeSize < 3)
-						shapeSize += Random::rand() % 3;
+						shapeSize += _random->rand() % 3;
 				}
 				Shape shape = generate_shape(area, pick_random(area), shapeSize);
 				if (shape.size() == region.size()) continue; //Don't allow the shape to match the region, to guarantee it will be wrong
@@ -1812,7 +2191,7 @@ bool Generate::place_erasers(const std::vector<int>& colors, const std::vector<i
 			if (hasFlag(Config::TreehouseLayout) || _panel->id == 0x289E7) { //If the block is adjacent to a start or exit, don't place a triangle there
 				bool found = false;
 				for (Point dir : _DIRECTIONS1) {
-					if (_starts.count(pos + dir) || _exits.count(pos + dir)) {
+					if (_starts.count(wrap(pos + dir)) || _exits.count(wrap(pos + dir))) {
 						found = true;
 						break;
 					}
@@ -1820,8 +2199,8 @@ bool Generate::place_erasers(const std::vector<int>& colors, const std::vector<i
 				if (found) continue;
 			}
 			int count = count_sides(pos);
-			if (count == 0) count = Random::rand() % 3 + 1;
-			else count = (count + (Random::rand() & 1)) % 3 + 1;
+			if (count == 0) count = _random->rand() % 3 + 1;
+			else count = (count + (_random->rand() & 1)) % 3 + 1;
 			set(pos, toErase | (count << 16));
 		}
 
@@ -1831,7 +2210,7 @@ bool Generate::place_erasers(const std::vector<int>& colors, const std::vector<i
 		}
 		//Place the eraser at a random open point
 		if (_splitPoints.size() == 0) pos = pick_random(open2);
-		else for (Point p : _splitPoints) if (region.count(p)) { pos = p; break; }
+		else for (Point p : _splitPoints) if (std::binary_search(region.begin(), region.end(), p)) { pos = p; break; }
 		if (_panel->id == 0x288FC && hasFlag(Generate::Config::DisableWrite)) {
 			if (get(5, 5) != 0) return false;
 			pos = { 5, 5 }; //For the puzzle in the cave with a pillar in middle
@@ -1855,7 +2234,7 @@ bool Generate::combine_shapes(std::vector<Shape>& shapes)
 			for (Point p1 : shapes[i]) {
 				for (Point p2 : shapes[j]) {
 					for (Point dir : _DIRECTIONS2) {
-						if (p1 + dir == p2) {
+						if (wrap(p1 + dir) == p2) {
 							//Combine shapes
 							for (Point p : shapes[i]) shapes[j].insert(p);
 							//Make sure there are no holes
@@ -1870,7 +2249,7 @@ bool Generate::combine_shapes(std::vector<Shape>& shapes)
 									Point p = check[check.size() - 1];
 									check.pop_back();
 									for (Point dir : _DIRECTIONS1) {
-										Point p2 = p + dir * 2;
+										Point p2 = wrap(p + dir * 2);
 										if (area.count(p2) && region.insert(p2).second) {
 											check.push_back(p2);
 										}
@@ -7,7 +7,15 @@
 #include <time.h>
 #include <set>
 #include <algorithm>
+#include <functional>
+#include <atomic>
 #include "Random.h"
+#include "Bitboard.h"
+#include "RegionMap.h"
+#include "Polyomino.h"
+#include "Profiler.h"
+#include "Benchmark.h"
+#include "Trace.h"
 
 typedef std::set<Point> Shape;
 
@@ -15,15 +23,20 @@ typedef std::set<Point> Shape;
 class Generate
 {
 public:
-	Generate() {
+	Generate(std::shared_ptr<Random> random) {
+		_random = random;
 		_width = _height = 0;
 		_areaTotal = _genTotal = _totalPuzzles = _areaPuzzles = _stoneTypes = 0;
 		_fullGaps = _bisect = _allowNonMatch = false;
 		_handle = NULL;
 		_panel = NULL;
 		_parity = -1;
+		_parallelAttempts = 1;
+		_speculative = false;
+		_verify = false;
+		_minDifficulty = _maxDifficulty = 0;
 		colorblind = false;
-		_seed = Random::rand();
+		_seed = _random->rand();
 		arrowColor = backgroundColor = successColor = { 0, 0, 0, 0 };
 		resetConfig();
 	}
@@ -35,7 +48,7 @@ public:
 		DisableReset = 0x40000000, MountainFloorH = 0x80000000
 	};
 	
-	void generate(int id) { PuzzleSymbols symbols({ }); while (!generate(id, symbols)); }
+	void generate(int id) { generate(id, std::vector<std::pair<int, int>>()); }
 	void generate(int id, int symbol, int amount);
 	void generate(int id, int symbol1, int amount1, int symbol2, int amount2);
 	void generate(int id, int symbol1, int amount1, int symbol2, int amount2, int symbol3, int amount3);
@@ -71,8 +84,14 @@ public:
 	void removeFlag(Config option) { _config &= ~option; };
 	void removeFlagOnce(Config option) { _config &= ~option; _oneTimeRemove |= option; };
 	void resetConfig();
-	void seed(long seed) { Random::seed(seed); _seed = Random::rand(); }
+	void seed(long seed) { _random->seed(seed); _seed = _random->rand(); }
 	void incrementProgress();
+	void setParallelAttempts(int amount) { _parallelAttempts = amount; } //Only used with counter-based streams, see retry
+	void setVerify(bool verify) { _verify = verify; } //Run the Solver on each panel made by generate, and try again if it finds no solution
+	bool cut_off(Point pos); //See Generate.cpp. Does nothing where it would change the puzzles of earlier versions
+	//Make generate try again until the panel's difficulty (see Solver::Stats::difficulty) is between min and max, for up to MaxDifficultyAttempts attempts. max = 0 - any difficulty.
+	//Nothing sets a band yet - the values for Normal and Expert still have to be measured on generated worlds
+	void setDifficulty(double min, double max) { _minDifficulty = min; _maxDifficulty = max; _difficultyAttempts.clear(); }
 
 	float pathWidth; //Controls how thick the line is on the puzzle
 	std::vector<Point> hitPoints; //The generated path will be forced to hit these points in order
@@ -81,38 +100,58 @@ public:
 	std::set<Point> customPath; 
 	Color arrowColor, backgroundColor, successColor; //For the arrow puzzles
 
+	struct SolutionCount {
+		int id;
+		int solutions; //Capped at 2, -1 if the solver ran out of steps
+		long long microseconds;
+	};
+	std::shared_ptr<Benchmark> benchmark; //If set, PuzzleList times the areas and the panels written in them into this
+	std::shared_ptr<Profiler> profiler; //If set, the attempts at each panel and the stages of generate they fail at are counted into this
+	std::shared_ptr<std::vector<SolutionCount>> solutionCounts; //If set, generate_maze adds the solutions of every maze it makes (rejected ones included). Not thread safe, so retry doesn't pass it on to the copies it runs attempts on
+
 private:
 
 	int get(Point pos) { return _panel->_grid[pos.first][pos.second]; }
-	void set(Point pos, int val) { _panel->_grid[pos.first][pos.second] = val; }
+	void set(Point pos, int val) { TRACE_WRITE("set", _panel->id, pos.first, pos.second, val); _regions.update(pos, _panel->_grid[pos.first][pos.second], val); _panel->_grid[pos.first][pos.second] = val; }
 	int get(int x, int y) { return _panel->_grid[x][y]; }
-	void set(int x, int y, int val) { _panel->_grid[x][y] = val; }
+	void set(int x, int y, int val) { TRACE_WRITE("set", _panel->id, x, y, val); _regions.update(Point(x, y), _panel->_grid[x][y], val); _panel->_grid[x][y] = val; }
 	int get_symbol_type(int flags) { return flags & 0x700; }
 	void set_path(Point pos);
+	void unset_path(Point pos);
 	Point get_sym_point(Point pos) { return _panel->get_sym_point(pos); }
 	int get_parity(Point pos) { return (pos.first / 2 + pos.second / 2) % 2; }
 	void clear();
 	void resetVars();
+	bool legacy() { return _random->mode() == Random::Sequential; } //Sequential streams keep the rules of earlier versions, so seeds still make the same puzzles
+	void retry(int id, const std::function<bool(Generate&)>& attempt);
 	void init_treehouse_layout();
-	template <class T> T pick_random(const std::vector<T>& vec) { return vec[Random::rand() % vec.size()]; }
-	template <class T> T pick_random(const std::set<T>& set) { auto it = set.begin(); std::advance(it, Random::rand() % set.size()); return *it; }
-	template <class T> T pop_random(const std::vector<T>& vec) { int i = Random::rand() % vec.size(); T item = vec[i]; vec.erase(vec.begin() + i); return item; }
+	template <class T> T pick_random(const std::vector<T>& vec) { return vec[_random->rand() % vec.size()]; }
+	template <class T> T pick_random(const std::set<T>& set) { auto it = set.begin(); std::advance(it, _random->rand() % set.size()); return *it; }
+	Point pick_random(const Bitboard& set) { return set.nth(_random->rand() % set.size()); }
+	template <class T> T pop_random(const std::vector<T>& vec) { int i = _random->rand() % vec.size(); T item = vec[i]; vec.erase(vec.begin() + i); return item; }
 	template <class T> T pop_random(const std::set<T>& set) { T item = pick_random(set); set.erase(item); return item; }
-	bool on_edge(Point p) { return (Point::pillarWidth == 0 && (p.first == 0 || p.first + 1 == _panel->_width) || p.second == 0 || p.second + 1 == _panel->_height); }
+	bool on_edge(Point p) { return (_panel->_pillarWidth == 0 && (p.first == 0 || p.first + 1 == _panel->_width) || p.second == 0 || p.second + 1 == _panel->_height); }
 	bool off_edge(Point p) { return (p.first < 0 || p.first >= _panel->_width || p.second < 0 || p.second >= _panel->_height); }
-	static std::vector<Point> _DIRECTIONS1, _8DIRECTIONS1, _DIRECTIONS2, _8DIRECTIONS2, _SHAPEDIRECTIONS, _DISCONNECT;
+	Point wrap(Point p) { return p.wrap(_panel->_pillarWidth); } //pos + dir and the like have to go through this to go around a pillar
+	static std::vector<Point> _DIRECTIONS1, _8DIRECTIONS1, _DIRECTIONS2, _8DIRECTIONS2, _DISCONNECT;
 	bool generate_maze(int id, int numStarts, int numExits);
 	bool generate(int id, PuzzleSymbols symbols); //************************************************************
-	bool place_all_symbols(PuzzleSymbols& symbols);
+	bool place_all_symbols(PuzzleSymbols& symbols, Profiler::Timer& timer); //timer - times each stage for the profiler
+	bool place_all_symbols(PuzzleSymbols& symbols) { Profiler::Timer timer; return place_all_symbols(symbols, timer); }
+	bool in_difficulty_band(int id);
 	bool generate_path(PuzzleSymbols& symbols);
 	bool generate_path_length(int minLength, int maxLength);
 	bool generate_path_length(int minLength) { return generate_path_length(minLength, 10000); };
-	bool generate_path_regions(int minRegions);
+	bool extend_path(Point pos, Point exit, int minLength, int maxLength, int& budget);
+	bool can_extend_path(Point pos, Point dir);
+	bool generate_path_regions(int minRegions, int minSize = 1);
 	bool generate_longest_path();
+	bool generate_covering_path(Point pos, Point exit, Point block);
 	bool generate_special_path();
 	void erase_path();
 	Point adjust_point(Point pos);
 	std::set<Point> get_region(Point pos);
+	void label_regions();
 	std::vector<int> get_symbols_in_region(Point pos);
 	std::vector<int> get_symbols_in_region(const std::set<Point>& region);
 	bool place_start(int amount);
@@ -121,16 +160,26 @@ private:
 	bool place_gaps(int amount);
 	bool can_place_dot(Point pos, bool intersectionOnly);
 	bool place_dots(int amount, int color, bool intersectionOnly);
-	bool can_place_stone(const std::set<Point>& region, int color);
+	bool can_place_stone(Point pos, int color);
 	bool place_stones(int color, int amount);
-	Shape generate_shape(std::set<Point>& region, std::set<Point>& bufferRegion, Point pos, int maxSize);
-	Shape generate_shape(std::set<Point>& region, Point pos, int maxSize) { std::set<Point> buffer; return generate_shape(region, buffer, pos, maxSize); }
-	int make_shape_symbol(Shape shape, bool rotated, bool negative, int rotation, int depth);
-	int make_shape_symbol(const Shape& shape, bool rotated, bool negative) { return make_shape_symbol(shape, rotated, negative, -1, 0); }
+	Shape generate_shape(Bitboard& region, Bitboard& bufferRegion, Point pos, int maxSize);
+	Shape generate_shape(Bitboard& region, Point pos, int maxSize) { Bitboard buffer; return generate_shape(region, buffer, pos, maxSize); }
+	//State of the search splitting a region into shapes (see partition_region)
+	struct ShapePartition {
+		Bitboard region, bufferRegion; //Blocks still to cover - those in bufferRegion are covered twice, as in generate_shape
+		std::vector<Shape> shapes;
+		int maxShapes, targetSize, maxSize;
+		int budget; //Search steps left
+	};
+	bool partition_region(ShapePartition& part);
+	bool grow_partition_shape(ShapePartition& part, Shape& shape, std::vector<Point> untried, const Bitboard& seen);
+	bool fits_shape_box(const Shape& shape, Point pos);
+	int make_shape_symbol(Shape shape, bool rotated, bool negative, int rotation, int depth, bool weighed = false);
+	int make_shape_symbol(const Shape& shape, bool rotated, bool negative, bool weighed = false) { return make_shape_symbol(shape, rotated, negative, -1, 0, weighed); }
 	bool place_shapes(const std::vector<int>& colors, const std::vector<int>& negativeColors, int amount, int numRotated, int numNegative);
-	int count_color(const std::set<Point>& region, int color);
+	int count_color(Point pos, int color);
 	bool place_stars(int color, int amount);
-	bool has_star(const std::set<Point>& region, int color);
+	bool has_star(Point pos, int color);
 	bool checkStarZigzag(std::shared_ptr<Panel> panel);
 	bool place_triangles(int color, int amount, int targetCount);
 	int count_sides(Point pos);
@@ -140,20 +189,32 @@ private:
 	bool combine_shapes(std::vector<Shape>& shapes);
 
 	std::shared_ptr<Panel> _panel;
+	std::shared_ptr<Random> _random; //Shared with every other generator taking part in the same run
 	std::vector<std::vector<int>> _custom_grid;
 	int _width, _height;
 	Panel::Symmetry _symmetry;
 	std::set<Point> _starts, _exits;
-	std::set<Point> _gridpos, _openpos;
-	std::set<Point> _path, _path1, _path2;
+	Bitboard _gridpos, _openpos;
+	Bitboard _path, _path1, _path2;
+	RegionMap _regions; //See label_regions
 	bool _fullGaps, _bisect;
 	int _stoneTypes;
 	int _config;
 	int _oneTimeAdd, _oneTimeRemove;
 	long _seed;
 	std::vector<Point> _splitPoints;
+	std::vector<Point> _shapeDirections; //Directions generate_shape may grow in, set by place_all_symbols to one of the lists above
 	bool _allowNonMatch; //Used for multi-generator
 	int _parity;
+	int _parallelAttempts;
+	bool _speculative; //Attempt running on a copy of the generator in retry - if it is kept, the original generator writes it
+	const std::atomic<int>* _best = nullptr; //Parallel attempt in retry - the index of the best successful attempt so far
+	int _attemptIndex = 0;
+	bool cancelled() const { return _best && *_best < _attemptIndex; } //An earlier attempt has succeeded, so this one can give up
+	bool _verify;
+	double _minDifficulty, _maxDifficulty;
+	std::map<int, int> _difficultyAttempts; //Attempts at each panel checked by in_difficulty_band, with sequential streams (counter-based streams keep count themselves)
+	static const int MaxDifficultyAttempts = 200;
 	std::vector<std::vector<Point>> _obstructions;
 	bool colorblind;
 
@@ -0,0 +1,18 @@
+#Writes GeneratorHash.h, holding a hash of the sources that decide which puzzles a seed gives, so that world images made by a build with different
+#generators aren't taken from the cache (see WorldImage::Key). Run by the Source project before every build. The header is only rewritten when the
+#hash changes, so that nothing is compiled again for no reason. Line endings are left out of the hash.
+$files = @('Bitboard.h', 'Generate.cpp', 'Generate.h', 'MultiGenerate.cpp', 'MultiGenerate.h', 'Panel.cpp', 'Panel.h', 'Polyomino.cpp', 'Polyomino.h',
+	'PuzzleList.cpp', 'PuzzleList.h', 'PuzzleSymbols.h', 'Random.cpp', 'Random.h', 'Randomizer.cpp', 'RegionMap.cpp', 'RegionMap.h', 'Solver.cpp',
+	'Solver.h', 'Special.cpp', 'Special.h')
+$text = ''
+foreach ($file in $files) {
+	$text += $file + "`n" + ((Get-Content -Raw (Join-Path $PSScriptRoot $file)) -replace "`r`n", "`n")
+}
+$sha = [System.Security.Cryptography.SHA256]::Create()
+$bytes = $sha.ComputeHash([System.Text.Encoding]::UTF8.GetBytes($text))
+$hash = '0x' + (($bytes[0..3] | ForEach-Object { $_.ToString('x2') }) -join '')
+$header = "#pragma once`r`n//Written by GeneratorHash.ps1 before each build, don't edit`r`n#define GENERATOR_SOURCE_HASH ${hash}u`r`n"
+$path = Join-Path $PSScriptRoot 'GeneratorHash.h'
+if (!(Test-Path $path) -or (Get-Content -Raw $path) -ne $header) {
+	Set-Content -NoNewline -Encoding ASCII -Path $path -Value $header
+}
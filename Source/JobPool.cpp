@@ -0,0 +1,158 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "JobPool.h"
+#include <chrono>
+
+int JobPool::Add(std::function<void()> job, const std::vector<int>& dependencies) {
+	int index = static_cast<int>(_jobs.size());
+	_jobs.emplace_back();
+	_jobs[index].run = job;
+	for (int dependency : dependencies) {
+		if (dependency < 0 || dependency >= index) throw std::exception("Jobs can only depend on jobs added before them");
+		_jobs[dependency].dependents.push_back(index);
+		_jobs[index].numDependencies++;
+	}
+	return index;
+}
+
+void JobPool::Run(int numThreads, std::function<void(int, int)> progress) {
+	if (numThreads < 1) numThreads = 1;
+	const int total = static_cast<int>(_jobs.size());
+	_workers.clear();
+	for (int i = 0; i < numThreads; i++) _workers.push_back(std::make_unique<Worker>());
+	_finished = 0;
+	_queued = 0;
+	_failed = false;
+	int next = 0;
+	for (int i = 0; i < total; i++) {
+		_jobs[i].waiting = _jobs[i].numDependencies;
+		_jobs[i].error = nullptr;
+		if (_jobs[i].waiting == 0) Push(next++ % numThreads, i);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_stateLock);
+		_numWorkers = numThreads;
+		_started = 0;
+		_run++;
+	}
+	while (_threads.size() < numThreads) _threads.emplace_back(&JobPool::Thread, this, static_cast<int>(_threads.size()));
+	_wake.notify_all();
+	{
+		//Every thread taking part has to be done with the run before the next one is set up
+		std::unique_lock<std::mutex> lock(_stateLock);
+		while (_finished < total || _started < numThreads || _busy > 0) {
+			if (progress) {
+				int finished = _finished;
+				lock.unlock();
+				progress(finished, total);
+				lock.lock();
+			}
+			_done.wait_for(lock, std::chrono::milliseconds(100));
+		}
+	}
+	_workers.clear();
+	if (progress) progress(total, total);
+	for (Job& job : _jobs) {
+		if (job.error) std::rethrow_exception(job.error);
+	}
+}
+
+JobPool::~JobPool() {
+	{
+		std::lock_guard<std::mutex> lock(_stateLock);
+		_stop = true;
+	}
+	_wake.notify_all();
+	for (std::thread& thread : _threads) thread.join();
+}
+
+//Waits for each run this thread takes part in, and works on it until it is finished
+void JobPool::Thread(int index) {
+	int seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_stateLock);
+			_wake.wait(lock, [&] { return _stop || _run != seen && index < _numWorkers; });
+			if (_stop) return;
+			seen = _run;
+			_started++;
+			_busy++;
+		}
+		Work(index);
+		std::lock_guard<std::mutex> lock(_stateLock);
+		_busy--;
+		_done.notify_all();
+	}
+}
+
+void JobPool::Work(int worker) {
+	const int total = static_cast<int>(_jobs.size());
+	while (true) {
+		int job;
+		if (Take(worker, job)) {
+			if (!_failed) {
+				try {
+					_jobs[job].run();
+				}
+				catch (...) {
+					_jobs[job].error = std::current_exception();
+					_failed = true;
+				}
+			}
+			Finish(worker, job);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(_stateLock);
+		_wake.wait(lock, [&] { return _queued > 0 || _finished == total; });
+		if (_queued == 0 && _finished == total) return;
+	}
+}
+
+//Own queue first (most recently readied job, whose data is most likely still in cache), then the oldest job of the other workers
+bool JobPool::Take(int worker, int& job) {
+	const int numWorkers = static_cast<int>(_workers.size());
+	for (int i = 0; i < numWorkers; i++) {
+		Worker& other = *_workers[(worker + i) % numWorkers];
+		std::lock_guard<std::mutex> lock(other.lock);
+		if (other.queue.empty()) continue;
+		if (i == 0) {
+			job = other.queue.back();
+			other.queue.pop_back();
+		}
+		else {
+			job = other.queue.front();
+			other.queue.pop_front();
+		}
+		_queued--;
+		return true;
+	}
+	return false;
+}
+
+void JobPool::Push(int worker, int job) {
+	{
+		std::lock_guard<std::mutex> lock(_workers[worker]->lock);
+		_workers[worker]->queue.push_back(job);
+	}
+	std::lock_guard<std::mutex> lock(_stateLock);
+	_queued++;
+	_wake.notify_all();
+}
+
+void JobPool::Finish(int worker, int job) {
+	std::vector<int> ready;
+	{
+		std::lock_guard<std::mutex> lock(_stateLock);
+		for (int dependent : _jobs[job].dependents) {
+			if (--_jobs[dependent].waiting == 0) ready.push_back(dependent);
+		}
+	}
+	for (int dependent : ready) Push(worker, dependent);
+	std::lock_guard<std::mutex> lock(_stateLock);
+	_finished++;
+	_wake.notify_all();
+	_done.notify_all();
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <exception>
+
+//Runs a graph of jobs on a pool of worker threads. A job is ready to run once every job it depends on has finished.
+//Each worker keeps its own queue of ready jobs (newest first) and steals the oldest job from another worker when its queue is empty.
+//The threads are started by the first Run that needs them and kept until the pool is destroyed, so a pool can be cleared and run again cheaply.
+class JobPool
+{
+public:
+	JobPool() { }
+	JobPool(const JobPool&) = delete;
+	JobPool& operator=(const JobPool&) = delete;
+	~JobPool();
+
+	//Returns the index of the job, to be used as a dependency of later jobs
+	int Add(std::function<void()> job, const std::vector<int>& dependencies = {});
+
+	//Runs every job added so far on numThreads workers and waits for them, calling progress(finished, total) on the calling thread every so often.
+	//If a job throws, the jobs that haven't started yet are skipped and the exception of the first failed job (in the order they were added) is rethrown.
+	void Run(int numThreads, std::function<void(int, int)> progress = nullptr);
+
+	//Removes every job, so that another set can be added and run. Not while running
+	void Clear() { _jobs.clear(); }
+
+	static int DefaultThreads() { int n = static_cast<int>(std::thread::hardware_concurrency()); return n > 0 ? n : 1; }
+
+private:
+	struct Job {
+		std::function<void()> run;
+		std::vector<int> dependents;
+		int numDependencies = 0;
+		int waiting = 0;
+		std::exception_ptr error;
+	};
+	struct Worker {
+		std::deque<int> queue;
+		std::mutex lock;
+	};
+
+	void Thread(int index);
+	void Work(int worker);
+	bool Take(int worker, int& job);
+	void Push(int worker, int job);
+	void Finish(int worker, int job);
+
+	std::vector<Job> _jobs;
+	std::vector<std::unique_ptr<Worker>> _workers;
+	std::atomic<int> _queued = 0;
+	std::atomic<bool> _failed = false;
+	int _finished = 0;
+	std::vector<std::thread> _threads;
+	int _numWorkers = 0; //Threads taking part in the current run
+	int _run = 0; //Number of runs started
+	int _started = 0, _busy = 0; //Threads that have joined the current run, and those still working on it
+	bool _stop = false;
+	std::mutex _stateLock;
+	std::condition_variable _wake, _done;
+};
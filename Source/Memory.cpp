@@ -7,6 +7,7 @@
 #include <psapi.h>
 #include <tlhelp32.h>
 #include <iostream>
+#include <unordered_map>
 
 #undef PROCESSENTRY32
 #undef Process32Next
@@ -132,6 +133,7 @@ void* Memory::ComputeOffset(std::vector<int> offsets)
 	int final_offset = offsets.back();
 	offsets.pop_back();
 
+	std::lock_guard<std::recursive_mutex> lock(_cacheMutex);
 	uintptr_t cumulativeAddress =  _baseAddress;
 	for (const int offset : offsets) {
 		cumulativeAddress += offset;
@@ -152,6 +154,74 @@ void* Memory::ComputeOffset(std::vector<int> offsets)
 	return reinterpret_cast<void*>(cumulativeAddress + final_offset);
 }
 
+//Dry run overlay - written bytes are kept per 4 KB page, along with which bytes of the page have been written.
+//Arrays allocated during a dry run get addresses in a range the game doesn't use, and are never read from the game.
+#define OVERLAY_PAGE_SIZE 0x1000
+#define OVERLAY_HEAP_START 0x600000000000
+#define OVERLAY_HEAP_END 0x610000000000
+
+struct Memory::Overlay {
+	struct Page {
+		std::vector<byte> data = std::vector<byte>(OVERLAY_PAGE_SIZE);
+		std::vector<bool> written = std::vector<bool>(OVERLAY_PAGE_SIZE);
+	};
+	std::unordered_map<uintptr_t, Page> pages;
+	uintptr_t nextAlloc = OVERLAY_HEAP_START;
+	std::mutex lock; //The overlay may be shared by several threads (see JoinDryRun)
+};
+
+thread_local std::shared_ptr<Memory::Overlay> Memory::dryRun = nullptr;
+
+void Memory::StartDryRun() {
+	dryRun = std::make_shared<Overlay>();
+}
+
+void Memory::StopDryRun() {
+	dryRun = nullptr;
+}
+
+bool Memory::ReadOverlay(LPCVOID lpBaseAddress, LPVOID lpBuffer, SIZE_T nSize) {
+	uintptr_t address = reinterpret_cast<uintptr_t>(lpBaseAddress);
+	byte* buffer = static_cast<byte*>(lpBuffer);
+	//The game is read without holding the lock, so that the threads sharing the overlay only wait on each other to merge in what has been written
+	if (address >= OVERLAY_HEAP_START && address < OVERLAY_HEAP_END) memset(buffer, 0, nSize);
+	else if (!ReadProcess(lpBaseAddress, lpBuffer, nSize)) return false;
+	std::lock_guard<std::mutex> lock(dryRun->lock);
+	for (uintptr_t page = address & ~static_cast<uintptr_t>(OVERLAY_PAGE_SIZE - 1); page < address + nSize; page += OVERLAY_PAGE_SIZE) {
+		auto search = dryRun->pages.find(page);
+		if (search == dryRun->pages.end()) continue;
+		const Overlay::Page& data = search->second;
+		uintptr_t start = max(page, address), end = min(page + OVERLAY_PAGE_SIZE, address + nSize);
+		for (uintptr_t i = start; i < end; i++) {
+			if (data.written[i - page]) buffer[i - address] = data.data[i - page];
+		}
+	}
+	return true;
+}
+
+bool Memory::WriteOverlay(LPVOID lpBaseAddress, LPCVOID lpBuffer, SIZE_T nSize) {
+	uintptr_t address = reinterpret_cast<uintptr_t>(lpBaseAddress);
+	const byte* buffer = static_cast<const byte*>(lpBuffer);
+	std::lock_guard<std::mutex> lock(dryRun->lock);
+	for (uintptr_t page = address & ~static_cast<uintptr_t>(OVERLAY_PAGE_SIZE - 1); page < address + nSize; page += OVERLAY_PAGE_SIZE) {
+		Overlay::Page& data = dryRun->pages[page];
+		uintptr_t start = max(page, address), end = min(page + OVERLAY_PAGE_SIZE, address + nSize);
+		for (uintptr_t i = start; i < end; i++) {
+			data.data[i - page] = buffer[i - address];
+			data.written[i - page] = true;
+		}
+	}
+	return true;
+}
+
+uintptr_t Memory::AllocOverlay(size_t size) {
+	std::lock_guard<std::mutex> lock(dryRun->lock);
+	uintptr_t ptr = dryRun->nextAlloc;
+	dryRun->nextAlloc += (size + 15) & ~static_cast<size_t>(15);
+	if (dryRun->nextAlloc > OVERLAY_HEAP_END) ThrowError("Dry run is out of memory");
+	return ptr;
+}
+
 int Memory::GLOBALS = 0;
 bool Memory::showMsg = false;
 int Memory::globalsTests[3] = {
@@ -1,11 +1,14 @@
 #pragma once
 #include <functional>
 #include <map>
+#include <memory>
 #include <vector>
 #include <sstream>
 #include <iomanip>
 #include <fstream>
+#include <mutex>
 #include <windows.h>
+#include "WorldImage.h"
 // https://github.com/erayarslan/WriteProcessMemory-Example
 // http://stackoverflow.com/q/32798185
 // http://stackoverflow.com/q/36018838
@@ -22,6 +25,7 @@ public:
 
 	template <class T>
 	uintptr_t AllocArray(int id, int numItems) {
+		if (dryRun) return AllocOverlay(numItems * sizeof(T));
 		uintptr_t ptr = reinterpret_cast<uintptr_t>(VirtualAllocEx(_handle, 0, numItems * sizeof(T), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
 		return ptr;
 	}
@@ -32,16 +36,12 @@ public:
 	}
 
 	bool Read(LPCVOID lpBaseAddress, LPVOID lpBuffer, SIZE_T nSize) {
-		if (!retryOnFail) return ReadProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr);
-		for (int i = 0; i < 10000; i++) {
-			if (ReadProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr)) {
-				return true;
-			}
-		}
-		return false;
+		if (dryRun) return ReadOverlay(lpBaseAddress, lpBuffer, nSize);
+		return ReadProcess(lpBaseAddress, lpBuffer, nSize);
 	}
 
 	bool Write(LPVOID lpBaseAddress, LPCVOID lpBuffer, SIZE_T nSize) {
+		if (dryRun) return WriteOverlay(lpBaseAddress, lpBuffer, nSize);
 		if (!retryOnFail) return WriteProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr);
 		for (int i = 0; i < 10000; i++) {
 			if (WriteProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr)) {
@@ -54,6 +54,7 @@ public:
 	template <class T>
 	std::vector<T> ReadArray(int panel, int offset, int size) {
 		if (size == 0) return std::vector<T>();
+		std::lock_guard<std::recursive_mutex> lock(_cacheMutex);
 		if (offset == 0x230 || offset == 0x238) { //Traced edge data - this moves sometimes so it should not be cached
 			//Invalidate cache entry for old array address
 			_computedAddresses.erase(reinterpret_cast<uintptr_t>(ComputeOffset({ GLOBALS, 0x18, panel * 8, offset })));
@@ -65,6 +66,9 @@ public:
 	template <class T>
 	void WriteArray(int panel, int offset, const std::vector<T>& data) {
 		if (data.size() == 0) return;
+		WorldImage::RecordArray(panel, offset, data, false);
+		WorldImage::Pause pause; //The pointer to the new array can't be reused, so it is not recorded
+		std::lock_guard<std::recursive_mutex> lock(_cacheMutex);
 		if (data.size() > _arraySizes[std::make_pair(panel, offset)]) {
 			//Invalidate cache entry for old array address
 			_computedAddresses.erase(reinterpret_cast<uintptr_t>(ComputeOffset({ GLOBALS, 0x18, panel * 8, offset })));
@@ -77,10 +81,34 @@ public:
 
 	template <class T>
 	void WriteArray(int panel, int offset, const std::vector<T>& data, bool force) {
+		WorldImage::RecordArray(panel, offset, data, force);
+		WorldImage::Pause pause;
+		std::lock_guard<std::recursive_mutex> lock(_cacheMutex);
 		if (force) _arraySizes[std::make_pair(panel, offset)] = 0;
 		WriteArray(panel, offset, data);
 	}
 
+	//The same as WriteArray for an array of elementSize byte elements given as raw bytes (see WorldImage::Apply). The sizes of the arrays are
+	//kept in elements, so the data is measured in elements too, and an array that fits is reused as it would be by WriteArray. Not recorded
+	void WriteArrayBytes(int panel, int offset, const std::vector<unsigned char>& data, int elementSize, bool force) {
+		if (data.size() == 0 || elementSize <= 0) return;
+		WorldImage::Pause pause;
+		std::lock_guard<std::recursive_mutex> lock(_cacheMutex);
+		if (force) _arraySizes[std::make_pair(panel, offset)] = 0;
+		if (data.size() / elementSize > _arraySizes[std::make_pair(panel, offset)]) {
+			_computedAddresses.erase(reinterpret_cast<uintptr_t>(ComputeOffset({ GLOBALS, 0x18, panel * 8, offset })));
+			uintptr_t ptr = AllocArray<unsigned char>(panel, data.size());
+			WritePanelData<uintptr_t>(panel, offset, { ptr });
+		}
+		WriteData<unsigned char>({ GLOBALS, 0x18, panel * 8, offset, 0 }, data);
+	}
+
+	//Records the size of an array already in the game without reading it, so that a later write that fits reuses the array
+	void SetArraySize(int panel, int offset, int size) {
+		std::lock_guard<std::recursive_mutex> lock(_cacheMutex);
+		if (size > 0) _arraySizes[std::make_pair(panel, offset)] = size;
+	}
+
 	template <class T>
 	std::vector<T> ReadPanelData(int panel, int offset, size_t size) {
 		if (size == 0) return std::vector<T>();
@@ -94,10 +122,21 @@ public:
 
 	template <class T>
 	void WritePanelData(int panel, int offset, const std::vector<T>& data) {
+		WorldImage::RecordPanelData(panel, offset, data);
 		WriteData<T>({ GLOBALS, 0x18, panel * 8, offset }, data);
 	}
 
-	void ClearOffsets() { _computedAddresses = std::map<uintptr_t, uintptr_t>(); }
+	void ClearOffsets() { std::lock_guard<std::recursive_mutex> lock(_cacheMutex); _computedAddresses = std::map<uintptr_t, uintptr_t>(); }
+
+	//Dry run - while active, writes made on the calling thread are kept in memory instead of being sent to the game, and reads on that thread see them.
+	//Used to generate worlds without touching the running game. Memory objects that outlive a dry run should call ClearOffsets afterwards.
+	static void StartDryRun();
+	static void StopDryRun();
+	static bool IsDryRun() { return dryRun != nullptr; }
+	//Lets a worker thread take part in another thread's dry run (pass nullptr to leave it again)
+	struct Overlay;
+	static std::shared_ptr<Overlay> GetDryRun() { return dryRun; }
+	static void JoinDryRun(std::shared_ptr<Overlay> overlay) { dryRun = overlay; }
 
 	static int GLOBALS;
 	static bool showMsg;
@@ -105,6 +144,21 @@ public:
 	bool retryOnFail = true;
 
 private:
+	bool ReadProcess(LPCVOID lpBaseAddress, LPVOID lpBuffer, SIZE_T nSize) {
+		if (!retryOnFail) return ReadProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr);
+		for (int i = 0; i < 10000; i++) {
+			if (ReadProcessMemory(_handle, lpBaseAddress, lpBuffer, nSize, nullptr)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static thread_local std::shared_ptr<Overlay> dryRun;
+	bool ReadOverlay(LPCVOID lpBaseAddress, LPVOID lpBuffer, SIZE_T nSize);
+	bool WriteOverlay(LPVOID lpBaseAddress, LPCVOID lpBuffer, SIZE_T nSize);
+	uintptr_t AllocOverlay(size_t size);
+
 	template<class T>
 	std::vector<T> ReadData(const std::vector<int>& offsets, size_t numItems) {
 		std::vector<T> data;
@@ -133,6 +187,7 @@ private:
 
 	std::map<uintptr_t, uintptr_t> _computedAddresses;
 	std::map<std::pair<int, int>, int> _arraySizes;
+	std::recursive_mutex _cacheMutex; //Guards the two caches above, so that generators on different threads can share one Memory
 	uintptr_t _baseAddress = 0;
 	HANDLE _handle = nullptr;
 
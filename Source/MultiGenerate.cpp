@@ -15,6 +15,7 @@ void MultiGenerate::generate(int id, const std::vector<std::shared_ptr<Generate>
 
 bool MultiGenerate::generate(int id, PuzzleSymbols symbols)
 {
+	_random->startPanel(id);
 	for (std::shared_ptr<Generate> g : generators) {
 		g->initPanel(id);
 		int fails = 0;
@@ -24,39 +25,9 @@ bool MultiGenerate::generate(int id, PuzzleSymbols symbols)
 		}
 	}
 
-	std::vector<std::string> solution1; //For debugging only
-	for (int y = 0; y < generators[0]->_panel->_height; y++) {
-		std::string row;
-		for (int x = 0; x < generators[0]->_panel->_width; x++) {
-			if (generators[0]->get(x, y) == PATH) {
-				row += "xx";
-			}
-			else row += "    ";
-		}
-		solution1.push_back(row);
-	}
-	std::vector<std::string> solution2; //For debugging only
-	for (int y = 0; y < generators[1]->_panel->_height; y++) {
-		std::string row;
-		for (int x = 0; x < generators[1]->_panel->_width; x++) {
-			if (generators[1]->get(x, y) == PATH) {
-				row += "xx";
-			}
-			else row += "    ";
-		}
-		solution2.push_back(row);
-	}
-	std::vector<std::string> solution3; //For debugging only
-	for (int y = 0; y < generators[2]->_panel->_height; y++) {
-		std::string row;
-		for (int x = 0; x < generators[2]->_panel->_width; x++) {
-			if (generators[2]->get(x, y) == PATH) {
-				row += "xx";
-			}
-			else row += "    ";
-		}
-		solution3.push_back(row);
-	}
+	TRACE_PATH("MultiGenerate::generate 1", generators[0]->_panel->id, generators[0]->_panel->_width, generators[0]->_panel->_height, [&](int x, int y) { return generators[0]->get(x, y) == PATH; });
+	TRACE_PATH("MultiGenerate::generate 2", generators[1]->_panel->id, generators[1]->_panel->_width, generators[1]->_panel->_height, [&](int x, int y) { return generators[1]->get(x, y) == PATH; });
+	TRACE_PATH("MultiGenerate::generate 3", generators[2]->_panel->id, generators[2]->_panel->_width, generators[2]->_panel->_height, [&](int x, int y) { return generators[2]->get(x, y) == PATH; });
 
 	if (!place_all_symbols(symbols))
 		return false;
@@ -87,15 +58,16 @@ bool MultiGenerate::can_place_gap(Point pos)
 
 bool MultiGenerate::place_stones(int color, int amount)
 {
-	std::set<Point> open = generators[0]->_openpos;
+	for (std::shared_ptr<Generate> g : generators) g->label_regions();
+	Bitboard open = generators[0]->_openpos;
 	while (amount > 0) {
 		if (open.size() < amount)
 			return false;
 		Point pos = pick_random(open);
 		bool valid = true;
 		for (std::shared_ptr<Generate> g : generators) {
-			std::set<Point> region = g->get_region(pos);
-			if (!g->can_place_stone(region, color)) {
+			const std::vector<Point>& region = g->_regions.region(pos);
+			if (!g->can_place_stone(pos, color)) {
 				for (Point p : region) open.erase(p);
 				valid = false;
 			}
@@ -116,32 +88,33 @@ bool MultiGenerate::place_stones(int color, int amount)
 
 bool MultiGenerate::place_stars(int color, int amount)
 {
-	std::set<Point> open = generators[0]->_openpos;
+	for (std::shared_ptr<Generate> g : generators) g->label_regions();
+	Bitboard open = generators[0]->_openpos;
 	int halfPoint = amount / 2;
 	for (std::shared_ptr<Generate> g : generators) g->_allowNonMatch = amount % 2;
 	while (amount > 0) {
 		if (open.size() < amount)
 			return false;
 		Point pos = pick_random(open);
-		std::vector<std::set<Point>> regions;
+		std::vector<const std::vector<Point>*> regions;
 		std::vector<std::shared_ptr<Generate>> nonMatch;
 		for (std::shared_ptr<Generate> g : generators) {
-			std::set<Point> region = g->get_region(pos);
+			const std::vector<Point>& region = g->_regions.region(pos);
 			if (region.size() == 1) {
 				for (Point p : region) open.erase(p);
 				continue;
 			}
-			int count = g->count_color(region, color);
+			int count = g->count_color(pos, color);
 			if (count == 0) {
 				if (amount <= halfPoint || amount == halfPoint + 1 && g->_allowNonMatch)
 					for (Point p : region) open.erase(p);
-				else regions.push_back(region);
+				else regions.push_back(&region);
 			}
 			else if (count == 1) {
-				if (amount <= halfPoint && !g->has_star(region, color) || amount > halfPoint && (!g->_allowNonMatch || g->has_star(region, color)))
+				if (amount <= halfPoint && !g->has_star(pos, color) || amount > halfPoint && (!g->_allowNonMatch || g->has_star(pos, color)))
 					for (Point p : region) open.erase(p);
 				else {
-					regions.push_back(region);
+					regions.push_back(&region);
 					if (amount > halfPoint) nonMatch.push_back(g);
 				}
 			}
@@ -151,7 +124,7 @@ bool MultiGenerate::place_stars(int color, int amount)
 		}
 		if (regions.size() < generators.size()) continue;
 		for (std::shared_ptr<Generate> g : nonMatch) g->_allowNonMatch = false;
-		for (std::set<Point>& region : regions) for (Point p : region) open.erase(p);
+		for (const std::vector<Point>* region : regions) for (Point p : *region) open.erase(p);
 		for (std::shared_ptr<Generate> g : generators) {
 			g->set(pos, Decoration::Star | color);
 			g->_openpos.erase(pos);
@@ -174,7 +147,7 @@ bool MultiGenerate::can_place_triangle(Point pos)
 
 bool MultiGenerate::place_triangles(int color, int amount)
 {
-	std::set<Point> open;
+	Bitboard open;
 	for (Point p : generators[0]->_openpos) {
 		if (can_place_triangle(p)) open.insert(p);
 	}
@@ -7,7 +7,7 @@ class MultiGenerate
 {
 public:
 
-	MultiGenerate() { splitStones = false; }
+	MultiGenerate(std::shared_ptr<Random> random) { _random = random; splitStones = false; }
 	~MultiGenerate() { }
 
 	std::vector<std::shared_ptr<Generate>> generators;
@@ -18,6 +18,8 @@ public:
 
 private:
 
+	std::shared_ptr<Random> _random;
+
 	bool generate(int id, PuzzleSymbols symbols);
 	bool place_all_symbols(PuzzleSymbols symbols);
 	bool can_place_gap(Point pos);
@@ -26,8 +28,9 @@ private:
 	bool can_place_triangle(Point pos);
 	bool place_triangles(int color, int amount);
 
-	template <class T> T pick_random(std::vector<T>& vec) { return vec[Random::rand() % vec.size()]; }
-	template <class T> T pick_random(std::set<T>& set) { auto it = set.begin(); std::advance(it, Random::rand() % set.size()); return *it; }
+	template <class T> T pick_random(std::vector<T>& vec) { return vec[_random->rand() % vec.size()]; }
+	template <class T> T pick_random(std::set<T>& set) { auto it = set.begin(); std::advance(it, _random->rand() % set.size()); return *it; }
+	Point pick_random(const Bitboard& set) { return set.nth(_random->rand() % set.size()); }
 
 	friend class Special;
 };
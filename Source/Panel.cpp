@@ -9,10 +9,14 @@
 #include "Watchdog.h"
 #include <sstream>
 #include <fstream>
+#include <algorithm>
 
-int Point::pillarWidth = 0;
 std::vector<Panel> Panel::generatedPanels;
 std::vector<std::tuple<int, int>> Panel::arrowPuzzles;
+const ColorPalette Panel::palettes[] = { make_palette(Default), make_palette(Reset), make_palette(Alternate), make_palette(WriteColors), make_palette(Treehouse), make_palette(TreehouseAlternate) };
+std::mutex Panel::staticMutex;
+Color Panel::xColor;
+bool Panel::xColorResolved = false;
 
 template <class T>
 int find(const std::vector<T> &data, T search, size_t startIndex = 0) {
@@ -31,16 +35,47 @@ Panel::Panel(int id) {
 	Read(id);
 }
 
+//Covers every field of the panel struct that Fetch and Decode use (the last one is NUM_COLORED_REGIONS)
+#define PANEL_SNAPSHOT_SIZE 0x4A0
+
+PanelSnapshot PanelSnapshot::Fetch(std::shared_ptr<Memory> memory, int id) {
+	PanelSnapshot snapshot;
+	snapshot.id = id;
+	snapshot.data = memory->ReadPanelData<byte>(id, 0, PANEL_SNAPSHOT_SIZE);
+	int numIntersections = snapshot.get<int>(NUM_DOTS);
+	int numConnections = snapshot.get<int>(NUM_CONNECTIONS);
+	int numDecorations = snapshot.get<int>(NUM_DECORATIONS);
+	snapshot.intersections = memory->ReadArray<float>(id, DOT_POSITIONS, numIntersections * 2);
+	snapshot.intersectionFlags = memory->ReadArray<int>(id, DOT_FLAGS, numIntersections);
+	if (snapshot.get<int>(REFLECTION_DATA)) snapshot.symmetryData = memory->ReadArray<int>(id, REFLECTION_DATA, numIntersections);
+	snapshot.connectionsA = memory->ReadArray<int>(id, DOT_CONNECTION_A, numConnections);
+	snapshot.connectionsB = memory->ReadArray<int>(id, DOT_CONNECTION_B, numConnections);
+	snapshot.decorations = memory->ReadArray<int>(id, DECORATIONS, numDecorations);
+	//Arrays that are written but never decoded - knowing their sizes lets Write reuse them
+	memory->SetArraySize(id, DECORATION_FLAGS, numDecorations);
+	if (snapshot.get<int>(DECORATION_COLORS)) memory->SetArraySize(id, DECORATION_COLORS, numDecorations);
+	memory->SetArraySize(id, COLORED_REGIONS, snapshot.get<int>(NUM_COLORED_REGIONS) * 4);
+	memory->SetArraySize(id, SEQUENCE, snapshot.get<int>(SEQUENCE_LEN));
+	memory->SetArraySize(id, DOT_SEQUENCE, snapshot.get<int>(DOT_SEQUENCE_LEN));
+	memory->SetArraySize(id, DOT_SEQUENCE_REFLECTION, snapshot.get<int>(DOT_SEQUENCE_LEN_REFLECTION));
+	return snapshot;
+}
+
 void Panel::Read() {
-	_width = 2 * _memory->ReadPanelData<int>(id, GRID_SIZE_X) - 1;
-	if (_memory->ReadPanelData<int>(id, IS_CYLINDER)) {
+	Decode(PanelSnapshot::Fetch(_memory, id));
+}
+
+void Panel::Decode(const PanelSnapshot& snapshot) {
+	id = snapshot.id;
+	_width = 2 * snapshot.get<int>(GRID_SIZE_X) - 1;
+	if (snapshot.get<int>(IS_CYLINDER)) {
 		_width++;
-		Point::pillarWidth = _width;
+		_pillarWidth = _width;
 	}
-	else Point::pillarWidth = 0;
-	_height = 2 * _memory->ReadPanelData<int>(id, GRID_SIZE_Y) - 1;
+	else _pillarWidth = 0;
+	_height = 2 * snapshot.get<int>(GRID_SIZE_Y) - 1;
 	if (_width <= 0 || _height <= 0 || _width > 30 || _height > 30) {
-		int numIntersections = _memory->ReadPanelData<int>(id, NUM_DOTS);
+		int numIntersections = snapshot.get<int>(NUM_DOTS);
 		_width = _height = static_cast<int>(std::round(sqrt(numIntersections))) * 2 - 1;
 	}
 	_grid.resize(_width);
@@ -53,10 +88,9 @@ void Panel::Read() {
 	_startpoints.clear();
 	_endpoints.clear();
 
-	_style = _memory->ReadPanelData<int>(id, STYLE_FLAGS);
-	ReadAllData();
-	ReadIntersections();
-	ReadDecorations();
+	_style = snapshot.get<int>(STYLE_FLAGS);
+	DecodeIntersections(snapshot);
+	DecodeDecorations(snapshot);
 	pathWidth = 1;
 	_resized = false;
 	colorMode = ColorMode::Default;
@@ -92,6 +126,7 @@ void Panel::Write() {
 	_memory->WritePanelData<int>(id, STYLE_FLAGS, { _style });
 	if (pathWidth != 1) _memory->WritePanelData<float>(id, PATH_WIDTH_SCALE, { pathWidth });
 	_memory->WritePanelData<int>(id, NEEDS_REDRAW, { 1 });
+	std::lock_guard<std::mutex> lock(staticMutex);
 	generatedPanels.push_back(*this);
 }
 
@@ -188,6 +223,7 @@ void Panel::Resize(int width, int height)
 	_resized = true;
 }
 
+//For debugging only - reads everything known about the panel so that it can be inspected
 void Panel::ReadAllData() {
 	Color pathColor = _memory->ReadPanelData<Color>(id, PATH_COLOR);
 	Color rpathColor = _memory->ReadPanelData<Color>(id, REFLECTION_PATH_COLOR);
@@ -248,18 +284,16 @@ void Panel::ReadAllData() {
 	std::vector<SolutionPoint> traced; if (tracedptr) traced = _memory->ReadArray<SolutionPoint>(id, TRACED_EDGE_DATA, numTraced);
 }
 
-void Panel::ReadDecorations() {
-	int numDecorations = _memory->ReadPanelData<int>(id, NUM_DECORATIONS);
-	std::vector<int> decorations = _memory->ReadArray<int>(id, DECORATIONS, numDecorations);
-	std::vector<int> decorationFlags = _memory->ReadArray<int>(id, DECORATION_FLAGS, numDecorations);
-
-	for (int i=0; i<numDecorations; i++) {
+void Panel::DecodeDecorations(const PanelSnapshot& snapshot) {
+	const std::vector<int>& decorations = snapshot.decorations;
+	for (int i=0; i<decorations.size(); i++) {
 		auto [x, y] = dloc_to_xy(i);
 		_grid[x][y] = decorations[i];
 	}
 }
 
 void Panel::WriteDecorations() {
+	const ColorPalette palette = get_palette();
 	std::vector<int> decorations;
 	std::vector<Color> decorationColors;
 	bool any = false;
@@ -279,7 +313,7 @@ void Panel::WriteDecorations() {
 				}
 			}
 			decorations.push_back(_grid[x][y]);
-			decorationColors.push_back(get_color_rgb(_grid[x][y] & 0xf));
+			decorationColors.push_back(palette[_grid[x][y]]);
 			if (_grid[x][y])
 				any = true;
 			if ((_grid[x][y] & 0x700) == Decoration::Shape::Stone) _style |= HAS_STONES;
@@ -309,21 +343,9 @@ void Panel::WriteDecorations() {
 		else if (colorMode == ColorMode::Reset || colorMode == ColorMode::Alternate) {
 			_memory->WritePanelData<int>(id, PUSH_SYMBOL_COLORS, { colorMode == ColorMode::Reset ? 0 : 1 });
 		}
-		if (colorMode == ColorMode::Treehouse) {
+		if (colorMode == ColorMode::Treehouse || colorMode == ColorMode::TreehouseAlternate) {
 			_memory->WritePanelData<int>(id, PUSH_SYMBOL_COLORS, { 1 });
-			_memory->WritePanelData<Color>(id, SYMBOL_A, { { 0, 0, 0, 1 } }); //Black
-			_memory->WritePanelData<Color>(id, SYMBOL_B, { { 1, 1, 1, 1 } }); //White
-			_memory->WritePanelData<Color>(id, SYMBOL_C, { { 1, 0.5, 0, 1 } }); //Orange
-			_memory->WritePanelData<Color>(id, SYMBOL_D, { { 1, 0, 1, 1 } }); //Magenta
-			_memory->WritePanelData<Color>(id, SYMBOL_E, { { 0, 1, 0, 1 } }); //Green
-		}
-		else if (colorMode == ColorMode::TreehouseAlternate) {
-			_memory->WritePanelData<int>(id, PUSH_SYMBOL_COLORS, { 1 });
-			_memory->WritePanelData<Color>(id, SYMBOL_A, { { 0, 0, 0, 1 } }); //Black
-			_memory->WritePanelData<Color>(id, SYMBOL_B, { { 0, 0, 1, 1 } }); //White->Blue
-			_memory->WritePanelData<Color>(id, SYMBOL_C, { { 1, 0.5, 0, 1 } }); //Orange
-			_memory->WritePanelData<Color>(id, SYMBOL_D, { { 1, 0, 1, 1 } }); //Magenta
-			_memory->WritePanelData<Color>(id, SYMBOL_E, { { 1, 1, 1, 1 } }); //Green->White
+			_memory->WritePanelData<Color>(id, SYMBOL_A, { palette.symbols, palette.symbols + 5 });
 		}
 	}
 	if (any || _memory->ReadPanelData<int>(id, DECORATIONS)) {
@@ -332,15 +354,62 @@ void Panel::WriteDecorations() {
 		_memory->WriteArray<int>(id, DECORATION_FLAGS, decorations);
 	}
 	if (arrows) {
-		arrowPuzzles.emplace_back(id, Point::pillarWidth);
+		std::lock_guard<std::mutex> lock(staticMutex);
+		arrowPuzzles.emplace_back(id, _pillarWidth);
 	}
 }
 
+//The X color is copied from the background of 0x0008F, so it is read from the game once per run. Everything else is a fixed table per color mode.
+ColorPalette Panel::get_palette() {
+	ColorPalette palette = palettes[colorMode];
+	if (colorMode == ColorMode::Treehouse || colorMode == ColorMode::TreehouseAlternate) return palette;
+	std::lock_guard<std::mutex> lock(staticMutex);
+	if (!xColorResolved) {
+		xColor = _memory->ReadPanelData<Color>(0x0008F, BACKGROUND_REGION_COLOR);
+		xColor.a = 1;
+		xColorResolved = true;
+	}
+	palette.colors[Decoration::Color::X] = xColor;
+	return palette;
+}
+
+ColorPalette Panel::make_palette(ColorMode mode) {
+	ColorPalette palette = { };
+	if (mode == ColorMode::Treehouse || mode == ColorMode::TreehouseAlternate) {
+		bool alternate = mode == ColorMode::TreehouseAlternate;
+		palette.colors[1] = { 0, 0, 0, 1 }; //Black
+		palette.colors[2] = alternate ? Color{ 0, 0, 1, 1 } : Color{ 1, 1, 1, 1 }; //White (->Blue)
+		palette.colors[3] = { 1, 0, 0, 1 }; //Red (Not used)
+		palette.colors[4] = { 1, 0, 1, 1 }; //Magenta
+		palette.colors[5] = { 1, 0.5, 0, 1 }; //Orange
+		palette.colors[6] = alternate ? Color{ 1, 1, 1, 1 } : Color{ 0, 1, 0, 1 }; //Green (->White)
+		palette.symbols[0] = palette.colors[1];
+		palette.symbols[1] = palette.colors[2];
+		palette.symbols[2] = palette.colors[5];
+		palette.symbols[3] = palette.colors[4];
+		palette.symbols[4] = palette.colors[6];
+		return palette;
+	}
+	palette.colors[Decoration::Color::Black] = { 0, 0, 0, 1 };
+	palette.colors[Decoration::Color::White] = { 1, 1, 1, 1 };
+	palette.colors[Decoration::Color::Red] = { 1, 0, 0, 1 };
+	palette.colors[Decoration::Color::Green] = { 0, 1, 0, 1 };
+	palette.colors[Decoration::Color::Blue] = { 0, 0, 1, 1 };
+	palette.colors[Decoration::Color::Cyan] = { 0, 1, 1, 1 };
+	palette.colors[Decoration::Color::Magenta] = { 1, 0, 1, 1 };
+	palette.colors[Decoration::Color::Yellow] = { 1, 1, 0, 1 };
+	palette.colors[Decoration::Color::Orange] = { 1, 0.5, 0, 1 };
+	palette.colors[Decoration::Color::Purple] = { 0.5, 0, 1, 1 };
+	return palette;
+}
+
 void Panel::StartArrowWatchdogs(const std::map<int, int>& shuffleMappings) {
 	std::map<int, int> invertedMappings;
 	for (const auto& [from, to] : shuffleMappings) {
 		invertedMappings[to] = from;
 	}
+	std::lock_guard<std::mutex> lock(staticMutex);
+	std::sort(arrowPuzzles.begin(), arrowPuzzles.end()); //The panels may have been generated in any order (see PuzzleList::GenerateAreas)
 	for (const auto& [id, pillarWidth] : arrowPuzzles) {
 		int realId = id;
 		if (invertedMappings.count(realId)) realId = invertedMappings.at(realId);
@@ -350,20 +419,19 @@ void Panel::StartArrowWatchdogs(const std::map<int, int>& shuffleMappings) {
 	}
 }
 
-void Panel::ReadIntersections() {
-	int numIntersections = _memory->ReadPanelData<int>(id, NUM_DOTS);
-	std::vector<float> intersections = _memory->ReadArray<float>(id, DOT_POSITIONS, numIntersections * 2);
+void Panel::DecodeIntersections(const PanelSnapshot& snapshot) {
+	int numIntersections = snapshot.get<int>(NUM_DOTS);
+	const std::vector<float>& intersections = snapshot.intersections;
 	int num_grid_points = this->get_num_grid_points();
 	minx = intersections[0]; miny = intersections[1];
 	maxx = intersections[num_grid_points * 2 - 2]; maxy = intersections[num_grid_points * 2 - 1];
 	if (minx > maxx) std::swap(minx, maxx);
 	if (miny > maxy) std::swap(miny, maxy);
 	unitWidth = (maxx - minx) / (_width - 1);
-	if (Point::pillarWidth) unitWidth = 1.0f / _width;
+	if (_pillarWidth) unitWidth = 1.0f / _width;
 	unitHeight = (maxy - miny) / (_height - 1);
-	std::vector<int> intersectionFlags = _memory->ReadArray<int>(id, DOT_FLAGS, numIntersections);
-	std::vector<int> symmetryData = _memory->ReadPanelData<int>(id, REFLECTION_DATA) ? 
-		_memory->ReadArray<int>(id, REFLECTION_DATA, numIntersections) : std::vector<int>();
+	const std::vector<int>& intersectionFlags = snapshot.intersectionFlags;
+	const std::vector<int>& symmetryData = snapshot.symmetryData;
 	if (symmetryData.size() == 0) symmetry = Symmetry::None;
 	else if (symmetryData[0] == num_grid_points - 1) symmetry = Symmetry::Rotational;
 	else if (symmetryData[0] == _width / 2 && intersections[1] == intersections[3]) symmetry = Symmetry::Vertical;
@@ -384,13 +452,11 @@ void Panel::ReadIntersections() {
 			_grid[x][y] = OPEN;
 		}
 	}
-	int numConnections = _memory->ReadPanelData<int>(id, NUM_CONNECTIONS);
-	std::vector<int> connections_a = _memory->ReadArray<int>(id, DOT_CONNECTION_A, numConnections);
-	std::vector<int> connections_b = _memory->ReadArray<int>(id, DOT_CONNECTION_B, numConnections);
+	int numConnections = snapshot.get<int>(NUM_CONNECTIONS);
+	const std::vector<int>& connections_a = snapshot.connectionsA;
+	const std::vector<int>& connections_b = snapshot.connectionsB;
 	//Remove non-existent connections
-	std::vector<std::string> out;
 	for (int i = 0; i < connections_a.size(); i++) {
-		out.push_back("(" + std::to_string(connections_a[i]) + ", " + std::to_string(connections_b[i]) + ")");
 		if (connections_a[i] >= num_grid_points || connections_b[i] >= num_grid_points) continue;
 		int x = static_cast<int>(std::round((intersections[connections_a[i] * 2] - minx) / unitWidth));
 		int y = _height - 1 - static_cast<int>(std::round((intersections[connections_a[i] * 2 + 1] - miny) / unitHeight));
@@ -471,7 +537,7 @@ void Panel::WriteIntersections() {
 	std::vector<int> polygons;
 
 	unitWidth = (maxx - minx) / (_width - 1);
-	if (Point::pillarWidth) unitWidth = 1.0f / _width;
+	if (_pillarWidth) unitWidth = 1.0f / _width;
 	unitHeight = (maxy - miny) / (_height - 1);
 
 	for (Point p : _startpoints) {
@@ -502,10 +568,11 @@ void Panel::WriteIntersections() {
 				connections_b.push_back(xy_to_loc(x, y));
 			}
 			if (symmetry) {
-				symmetryData.push_back(xy_to_loc(get_sym_point(x, y).first, get_sym_point(x, y).second));
+				Point sp = get_sym_point(x, y);
+				symmetryData.push_back(xy_to_loc(sp.first, sp.second));
 			}
 		}
-		if (Point::pillarWidth) {
+		if (_pillarWidth) {
 			connections_a.push_back(xy_to_loc(_width - 2, y));
 			connections_b.push_back(xy_to_loc(0, y));
 		}
@@ -529,7 +596,7 @@ void Panel::WriteIntersections() {
 		}
 	}
 
-	double endDist = Point::pillarWidth == 0 ? 0.05 : 0.03;
+	double endDist = _pillarWidth == 0 ? 0.05 : 0.03;
 
 	for (int i = 0; i < _endpoints.size(); i++) {
 		Endpoint endpoint = _endpoints[i];
@@ -8,14 +8,15 @@ struct Point {
 	int first;
 	int second;
 	Point() { first = 0; second = 0; };
-	Point(int x, int y) { if (pillarWidth) first = (x + pillarWidth) % pillarWidth; else first = x; second = y; }
+	Point(int x, int y) { first = x; second = y; }
 	Point operator+(const Point& p) { return { first + p.first, second + p.second }; }
 	Point operator*(int d) { return { first * d, second * d }; }
 	Point operator/(int d) { return { first / d, second / d }; }
 	bool operator==(const Point& p) const { return first == p.first && second == p.second; };
 	bool operator!=(const Point& p) const { return first != p.first || second != p.second; };
 	friend bool operator<(const Point& p1, const Point& p2) { if (p1.first == p2.first) return p1.second < p2.second; return p1.first < p2.first; };
-	static int pillarWidth;
+	//The same point with x taken around a pillar of the given width (see Panel::_pillarWidth). Unchanged if pillarWidth is 0
+	Point wrap(int pillarWidth) const { if (pillarWidth) return { (first + pillarWidth) % pillarWidth, second }; return *this; }
 };
 
 class Decoration
@@ -125,12 +126,39 @@ struct Color {
 	friend bool operator <(const Color& lhs, const Color& rhs) {return lhs.r * 8 + lhs.g * 4 + lhs.b * 2 + lhs.a > rhs.r * 8 + rhs.g * 4 + rhs.b * 2 + rhs.a;}
 };
 
+//Decoration colors as written into the game, indexed by the color bits of a decoration (see Panel::get_palette)
+struct ColorPalette {
+	Color colors[16];
+	Color symbols[5]; //SYMBOL_A-E, only written for the treehouse modes
+	const Color& operator[](int color) const { return colors[color & 0xf]; }
+};
+
 struct SolutionPoint {
 	int pointA, pointB, pointC, pointD;
 	float f1x, f1y, f2x, f2y, f3x, f3y, f4x, f4y;
 	int endnum;
 };
 
+//The raw data Panel::Read decodes a panel from, fetched from the game in a handful of reads. Decoding a snapshot doesn't touch the game.
+struct PanelSnapshot {
+	int id = 0;
+	std::vector<byte> data; //The start of the panel struct
+	std::vector<float> intersections;
+	std::vector<int> intersectionFlags;
+	std::vector<int> symmetryData;
+	std::vector<int> connectionsA;
+	std::vector<int> connectionsB;
+	std::vector<int> decorations;
+
+	template <class T> T get(int offset) const {
+		T value;
+		memcpy(&value, &data[offset], sizeof(T));
+		return value;
+	}
+
+	static PanelSnapshot Fetch(std::shared_ptr<Memory> memory, int id);
+};
+
 class Panel
 {
 public:
@@ -139,6 +167,7 @@ public:
 
 	void Read();
 	void Read(int id) { this->id = id; Read(); }
+	void Decode(const PanelSnapshot& snapshot);
 	void Write();
 	void Write(int id) { this->id = id; Write(); }
 
@@ -150,6 +179,8 @@ public:
 	void Resize(int width, int height);
 
 	static void StartArrowWatchdogs(const std::map<int, int>& shuffleMappings = {});
+	static void ClearGeneratedPanels() { std::lock_guard<std::mutex> lock(staticMutex); generatedPanels.clear(); arrowPuzzles.clear(); }
+	static void ClearPalettes() { std::lock_guard<std::mutex> lock(staticMutex); xColorResolved = false; }
 
 	enum Style {
 		SYMMETRICAL = 0x2, //Not on the town symmetry puzzles? IDK why.
@@ -179,13 +210,28 @@ public:
 
 private:
 
-	void ReadAllData();
-	void ReadIntersections();
-	void WriteIntersections();
-	void ReadDecorations();
-	void WriteDecorations();
+	//Symmetric points of every grid position for each symmetry, built on first use and rebuilt when the grid size changes
+	struct SymmetryTable {
+		int width = -1, height = -1, pillarWidth = -1;
+		std::vector<Point> points;
+	};
+	SymmetryTable _symTables[Symmetry::PillarRotational + 1];
+
+	const std::vector<Point>& get_sym_table(Symmetry symmetry) {
+		SymmetryTable& table = _symTables[symmetry];
+		if (table.width != _width || table.height != _height || table.pillarWidth != _pillarWidth) {
+			table.width = _width; table.height = _height; table.pillarWidth = _pillarWidth;
+			table.points.resize(_width * _height);
+			for (int x = 0; x < _width; x++) {
+				for (int y = 0; y < _height; y++) {
+					table.points[x * _height + y] = calc_sym_point(x, y, symmetry).wrap(_pillarWidth);
+				}
+			}
+		}
+		return table.points;
+	}
 
-	Point get_sym_point(int x, int y, Symmetry symmetry)
+	Point calc_sym_point(int x, int y, Symmetry symmetry)
 	{
 		switch (symmetry) {
 		case None: return Point(x, y);
@@ -208,77 +254,51 @@ private:
 		return Point(x, y);
 	}
 
+	void ReadAllData();
+	void DecodeIntersections(const PanelSnapshot& snapshot);
+	void WriteIntersections();
+	void DecodeDecorations(const PanelSnapshot& snapshot);
+	void WriteDecorations();
+
+	Point get_sym_point(int x, int y, Symmetry symmetry)
+	{
+		if (x < 0 || y < 0 || x >= _width || y >= _height) return calc_sym_point(x, y, symmetry).wrap(_pillarWidth);
+		return get_sym_table(symmetry)[x * _height + y];
+	}
+
 	Point get_sym_point(int x, int y) { return get_sym_point(x, y, symmetry); }
 	Point get_sym_point(Point p) { return get_sym_point(p.first, p.second, symmetry); }
 	Point get_sym_point(Point p, Symmetry symmetry) { return get_sym_point(p.first, p.second, symmetry); }
 	Endpoint::Direction get_sym_dir(Endpoint::Direction direction, Symmetry symmetry) {
+		//Reflected direction of LEFT, RIGHT, UP, DOWN for each symmetry
+		static const Endpoint::Direction mapping[][4] = {
+			{ Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }, //None
+			{ Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::DOWN, Endpoint::Direction::UP }, //Horizontal
+			{ Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }, //Vertical
+			{ Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT, Endpoint::Direction::DOWN, Endpoint::Direction::UP }, //Rotational
+			{ Endpoint::Direction::DOWN, Endpoint::Direction::UP, Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT }, //RotateLeft
+			{ Endpoint::Direction::UP, Endpoint::Direction::DOWN, Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT }, //RotateRight
+			{ Endpoint::Direction::UP, Endpoint::Direction::DOWN, Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT }, //FlipXY
+			{ Endpoint::Direction::DOWN, Endpoint::Direction::UP, Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT }, //FlipNegXY
+			{ Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }, //ParallelH
+			{ Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }, //ParallelV
+			{ Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }, //ParallelHFlip
+			{ Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::DOWN, Endpoint::Direction::UP }, //ParallelVFlip
+		};
 		int dirIndex;
 		if (direction == Endpoint::Direction::LEFT) dirIndex = 0;
-		if (direction == Endpoint::Direction::RIGHT) dirIndex = 1;
-		if (direction == Endpoint::Direction::UP) dirIndex = 2;
-		if (direction == Endpoint::Direction::DOWN) dirIndex = 3;
-		std::vector<Endpoint::Direction> mapping;
-		switch (symmetry) {
-		case Symmetry::Horizontal: mapping = { Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::DOWN, Endpoint::Direction::UP }; break;
-		case Symmetry::Vertical: mapping = { Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }; break;
-		case Symmetry::Rotational: mapping = { Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT, Endpoint::Direction::DOWN, Endpoint::Direction::UP }; break;
-		case Symmetry::RotateLeft: mapping = { Endpoint::Direction::DOWN, Endpoint::Direction::UP, Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT }; break;
-		case Symmetry::RotateRight: mapping = { Endpoint::Direction::UP, Endpoint::Direction::DOWN, Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT }; break;
-		case Symmetry::FlipXY: mapping = { Endpoint::Direction::UP, Endpoint::Direction::DOWN, Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT }; break;
-		case Symmetry::FlipNegXY: mapping = { Endpoint::Direction::DOWN, Endpoint::Direction::UP, Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT }; break;
-		case Symmetry::ParallelH: mapping = { Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }; break;
-		case Symmetry::ParallelV: mapping = { Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }; break;
-		case Symmetry::ParallelHFlip: mapping = { Endpoint::Direction::RIGHT, Endpoint::Direction::LEFT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }; break;
-		case Symmetry::ParallelVFlip: mapping = { Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::DOWN, Endpoint::Direction::UP }; break;
-		default: mapping = { Endpoint::Direction::LEFT, Endpoint::Direction::RIGHT, Endpoint::Direction::UP, Endpoint::Direction::DOWN }; break;
-		}
-		return mapping[dirIndex];
+		else if (direction == Endpoint::Direction::RIGHT) dirIndex = 1;
+		else if (direction == Endpoint::Direction::UP) dirIndex = 2;
+		else if (direction == Endpoint::Direction::DOWN) dirIndex = 3;
+		else return direction;
+		if (symmetry > Symmetry::ParallelVFlip) return mapping[Symmetry::None][dirIndex];
+		return mapping[symmetry][dirIndex];
 	}
 	int get_num_grid_points() { return ((_width + 1) / 2) * ((_height + 1) / 2); }
 	int get_num_grid_blocks() { return (_width / 2) * (_height / 2);  }
 	int get_parity() { return (get_num_grid_points() + 1) % 2; }
-	Color get_color_rgb(int color) {
-		if (colorMode == ColorMode::Treehouse) {
-			switch (color) {
-			case 1: return { 0, 0, 0, 1 }; //Black
-			case 2: return { 1, 1, 1, 1 }; //White
-			case 3: return { 1, 0, 0, 1 }; //Red (Not used)
-			case 4: return { 1, 0, 1, 1 }; //Magenta
-			case 5: return { 1, 0.5, 0, 1 }; //Orange
-			case 6: return { 0, 1, 0, 1 }; //Green
-			default: return { 0, 0, 0, 0 };
-			}
-		}
-		else if (colorMode == ColorMode::TreehouseAlternate) {
-			switch (color) {
-			case 1: return { 0, 0, 0, 1 }; //Black
-			case 2: return { 0, 0, 1, 1 }; //White->Blue
-			case 3: return { 1, 0, 0, 1 }; //Red (Not used)
-			case 4: return { 1, 0, 1, 1 }; //Magenta
-			case 5: return { 1, 0.5, 0, 1 }; //Orange
-			case 6: return { 1, 1, 1, 1 }; //Green->White
-			default: return { 0, 0, 0, 0 };
-			}
-		}
-		Color xcolor;
-		switch (color) {
-		case Decoration::Color::Black: return { 0, 0, 0, 1 };
-		case Decoration::Color::White: return { 1, 1, 1, 1 };
-		case Decoration::Color::Red: return { 1, 0, 0, 1 };
-		case Decoration::Color::Green: return { 0, 1, 0, 1 };
-		case Decoration::Color::Blue: return { 0, 0, 1, 1 };
-		case Decoration::Color::Cyan: return { 0, 1, 1, 1 };
-		case Decoration::Color::Magenta: return { 1, 0, 1, 1 };
-		case Decoration::Color::Yellow: return { 1, 1, 0, 1 };
-		case Decoration::Color::Orange: return { 1, 0.5, 0, 1 };
-		case Decoration::Color::Purple: return { 0.5, 0, 1, 1 };
-		case Decoration::Color::X: //Copy background color
-			xcolor = _memory->ReadPanelData<Color>(0x0008F, BACKGROUND_REGION_COLOR);
-			xcolor.a = 1;
-			return xcolor;
-		default: return { 0, 0, 0, 0 };
-		}
-	}
+	ColorPalette get_palette();
+	static ColorPalette make_palette(ColorMode mode);
 
 	std::pair<int, int> loc_to_xy(int location) {
 		int height2 = (_height - 1) / 2;
@@ -319,8 +339,8 @@ private:
 			std::pair<int,int> coord1 = loc_to_xy(connections_a[i]);
 			std::pair<int,int> coord2 = loc_to_xy(connections_b[i]);
 			int x1 = coord1.first, y1 = coord1.second, x2 = coord2.first, y2 = coord2.second;
-			if (Point::pillarWidth) {
-				if ((x1 == (x - 1 + Point::pillarWidth) % Point::pillarWidth && x2 == (x + 1) % Point::pillarWidth && y1 == y && y2 == y) ||
+			if (_pillarWidth) {
+				if ((x1 == (x - 1 + _pillarWidth) % _pillarWidth && x2 == (x + 1) % _pillarWidth && y1 == y && y2 == y) ||
 					(y1 == y - 1 && y2 == y + 1 && x1 == x && x2 == x)) {
 					return i;
 				}
@@ -425,6 +445,7 @@ private:
 	std::shared_ptr<Memory> _memory;
 
 	int _width, _height;
+	int _pillarWidth = 0; //Width that x wraps around at on a pillar (the columns go all the way around), 0 on other panels. Set when the panel is read
 
 	std::vector<std::vector<int>> _grid;
 	std::vector<Point> _startpoints;
@@ -436,6 +457,10 @@ private:
 
 	static std::vector<Panel> generatedPanels;
 	static std::vector<std::tuple<int, int>> arrowPuzzles;
+	static const ColorPalette palettes[ColorMode::TreehouseAlternate + 1];
+	static Color xColor;
+	static bool xColorResolved;
+	static std::mutex staticMutex; //Guards the static members above, which are shared by generators on all threads
 
 	friend class PanelExtractionTests;
 	friend class Generate;
@@ -443,4 +468,5 @@ private:
 	friend class Special;
 	friend class MultiGenerate;
 	friend class ArrowWatchdog;
+	friend class Solver;
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Polyomino.h"
+#include <climits>
+
+const Polyomino::Entry& Polyomino::Get(int mask)
+{
+	return Catalog()[mask & 0xFFFF];
+}
+
+int Polyomino::FromShape(const std::set<Point>& shape, int pillarWidth)
+{
+	if (shape.size() == 0) return 0;
+	int shift = 0;
+	for (int tries = (pillarWidth ? pillarWidth / 2 : 1); tries > 0; tries--, shift += 2) {
+		int xmin = INT_MAX, xmax = INT_MIN, ymin = INT_MAX, ymax = INT_MIN;
+		for (Point p : shape) {
+			int x = pillarWidth ? (p.first + shift) % pillarWidth : p.first;
+			if (x < xmin) xmin = x;
+			if (x > xmax) xmax = x;
+			if (p.second < ymin) ymin = p.second;
+			if (p.second > ymax) ymax = p.second;
+		}
+		if (ymax - ymin > 6) return 0;
+		if (xmax - xmin > 6) continue;
+		int mask = 0;
+		for (Point p : shape) {
+			int x = pillarWidth ? (p.first + shift) % pillarWidth : p.first;
+			mask |= 1 << ((x - xmin) / 2 + (ymax - p.second) * 2);
+		}
+		return mask;
+	}
+	return 0;
+}
+
+//The 2x2 square with another block attached comes up far more often than other shapes, so it is only kept a quarter of the time
+int Polyomino::Weight(int mask)
+{
+	switch (mask) {
+	case 0x0331: case 0x0332: case 0x0037: case 0x0067: case 0x0133: case 0x0233: case 0x0073: case 0x0076:
+		return 1;
+	}
+	return MaxWeight;
+}
+
+const std::vector<Polyomino::Entry>& Polyomino::Catalog()
+{
+	static const std::vector<Entry> catalog = [] {
+		std::vector<Entry> entries(0x10000, Entry { { 0, 0, 0, 0 }, 0, 0, false, false, MaxWeight });
+		for (int mask = 1; mask < 0x10000; mask++) {
+			if (Normalize(mask) != mask) continue;
+			Entry& entry = entries[mask];
+			entry.rotations[0] = mask;
+			entry.rotations[1] = RotateLeft(mask);
+			entry.rotations[2] = RotateRight(mask);
+			entry.rotations[3] = RotateLeft(entry.rotations[1]);
+			entry.canonical = mask;
+			for (int rotation : entry.rotations) if (rotation < entry.canonical) entry.canonical = rotation;
+			entry.size = Size(mask);
+			entry.connected = Connected(mask);
+			entry.symmetric = (entry.rotations[1] == mask);
+			entry.weight = Weight(mask);
+		}
+		return entries;
+	}();
+	return catalog;
+}
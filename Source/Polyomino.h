@@ -0,0 +1,64 @@
+#pragma once
+#include "Panel.h"
+#include <set>
+#include <vector>
+
+//Catalog of the shapes a shape symbol can show - every set of blocks that fits in its 4x4 grid (connected or not, as disconnected shapes are
+//possible too). Shapes are 16 bit masks in the same encoding as the upper 16 bits of a Decoration::Poly symbol: bit x + 4 * y is the block in
+//column x, row y counted from the bottom. A mask is normalized when it touches the bottom row and the left column.
+//The mask operations are constexpr. The catalog itself is built on first use, since scanning all 65536 masks would go past the compile time
+//evaluation limits.
+class Polyomino
+{
+public:
+	static const int MaxWeight = 4;
+
+	struct Entry {
+		int rotations[4]; //The shape as rotated by Generate::make_shape_symbol - 0: unchanged, 1: 90 degrees counter clockwise, 2: 90 degrees clockwise, 3: 180 degrees
+		int canonical; //Smallest of the rotations, shared by every rotation of the shape
+		int size;
+		bool connected;
+		bool symmetric; //Same when rotated by 90 degrees, so it can't be used as a rotated shape
+		int weight; //Out of MaxWeight - how likely the generator is to keep the shape when it comes up
+	};
+
+	//Catalog entry for a normalized mask
+	static const Entry& Get(int mask);
+	//Normalized mask of a shape made of grid blocks, or 0 if it doesn't fit in 4x4. On pillars (pillarWidth > 0) the shape is moved around the pillar until it fits
+	static int FromShape(const std::set<Point>& shape, int pillarWidth);
+
+	static constexpr int Normalize(int mask) {
+		if (mask == 0) return 0;
+		while ((mask & 0x1111) == 0) mask >>= 1;
+		while ((mask & 0x000F) == 0) mask >>= 4;
+		return mask;
+	}
+	static constexpr int RotateLeft(int mask) {
+		int result = 0;
+		for (int i = 0; i < 16; i++) if (mask & 1 << i) result |= 1 << ((3 - i / 4) + (i % 4) * 4);
+		return Normalize(result);
+	}
+	static constexpr int RotateRight(int mask) { return RotateLeft(RotateLeft(RotateLeft(mask))); }
+	static constexpr int Size(int mask) {
+		int size = 0;
+		for (; mask; mask &= mask - 1) size++;
+		return size;
+	}
+	static constexpr bool Connected(int mask) {
+		if (mask == 0) return false;
+		int reached = mask & -mask;
+		for (int last = 0; last != reached;) {
+			last = reached;
+			reached |= mask & (reached << 4 | reached >> 4 | (reached & 0x7777) << 1 | (reached & 0xEEEE) >> 1);
+		}
+		return reached == mask;
+	}
+
+private:
+	static int Weight(int mask);
+	static const std::vector<Entry>& Catalog();
+};
+
+static_assert(Polyomino::RotateLeft(0x000F) == 0x1111, "Horizontal bar turns into a vertical one");
+static_assert(Polyomino::RotateLeft(0x0017) == 0x0223 && Polyomino::RotateRight(0x0223) == 0x0017, "Rotations are inverses");
+static_assert(Polyomino::Connected(0x0033) && !Polyomino::Connected(0x0009), "Only edge-adjacent blocks connect");
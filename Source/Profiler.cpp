@@ -0,0 +1,50 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+static const char* StageNames[] = { "path", "shapes", "stones", "triangles", "arrows", "stars", "erasers", "dots", "gaps", "verify", "difficulty" };
+
+void Profiler::AddAttempt(int panel)
+{
+	std::lock_guard<std::mutex> guard(_lock);
+	_panels[panel].attempts++;
+}
+
+void Profiler::AddStage(int panel, Stage stage, bool passed, long long microseconds)
+{
+	std::lock_guard<std::mutex> guard(_lock);
+	PanelStats& stats = _panels[panel];
+	if (!passed) stats.failures[stage]++;
+	stats.microseconds[stage] += microseconds;
+}
+
+bool Profiler::WriteCSV(const std::string& filename)
+{
+	std::lock_guard<std::mutex> guard(_lock);
+	std::vector<std::pair<long long, int>> order;
+	for (const std::pair<const int, PanelStats>& panel : _panels) {
+		long long total = 0;
+		for (int i = 0; i < NumStages; i++) total += panel.second.microseconds[i];
+		order.emplace_back(-total, panel.first);
+	}
+	std::sort(order.begin(), order.end());
+
+	std::ofstream file(filename, std::ofstream::trunc);
+	if (!file) return false;
+	file << "panel,attempts,total_us";
+	for (const char* name : StageNames) file << "," << name << "_failures," << name << "_us";
+	file << std::endl;
+	for (const std::pair<long long, int>& entry : order) {
+		const PanelStats& stats = _panels[entry.second];
+		file << "0x" << std::hex << std::setw(5) << std::setfill('0') << entry.second << std::dec << "," << stats.attempts << "," << -entry.first;
+		for (int i = 0; i < NumStages; i++) file << "," << stats.failures[i] << "," << stats.microseconds[i];
+		file << std::endl;
+	}
+	return file.good();
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+//Counts the attempts the generator makes at each panel, and for each stage of an attempt (see Generate::generate and place_all_symbols) how often it
+//failed and how long it took. Shared by every generator taking part in a run, including those on other threads.
+class Profiler
+{
+public:
+	enum Stage { Path, Shapes, Stones, Triangles, Arrows, Stars, Erasers, Dots, Gaps, Verify, Difficulty, NumStages };
+
+	struct PanelStats {
+		int attempts = 0;
+		int failures[NumStages] = {};
+		long long microseconds[NumStages] = {};
+	};
+
+	//Times the stages of one attempt, one after another - each lap ends the stage being timed and starts the next. Does nothing without a profiler
+	class Timer {
+	public:
+		Timer() : Timer(nullptr, 0) { }
+		Timer(Profiler* profiler, int panel) {
+			_profiler = profiler;
+			_panel = panel;
+			if (!_profiler) return;
+			_profiler->AddAttempt(panel);
+			_start = std::chrono::steady_clock::now();
+		}
+		//Returns passed, so a failed stage can end with return timer.lap(stage, false)
+		bool lap(Stage stage, bool passed = true) {
+			if (!_profiler) return passed;
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			_profiler->AddStage(_panel, stage, passed, std::chrono::duration_cast<std::chrono::microseconds>(now - _start).count());
+			_start = now;
+			return passed;
+		}
+
+	private:
+		Profiler* _profiler;
+		int _panel;
+		std::chrono::steady_clock::time_point _start;
+	};
+
+	void AddAttempt(int panel);
+	void AddStage(int panel, Stage stage, bool passed, long long microseconds);
+
+	//One line per panel, the panels that took longest first
+	bool WriteCSV(const std::string& filename);
+
+private:
+	std::map<int, PanelStats> _panels;
+	std::mutex _lock;
+};
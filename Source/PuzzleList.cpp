@@ -5,53 +5,128 @@
 #include "PuzzleList.h"
 #include "Watchdog.h"
 
+struct AreaInfo {
+	PuzzleList::Area generate;
+	const char* name; //For the benchmark
+};
+
+static const std::vector<AreaInfo> AreasN = {
+	{ &PuzzleList::GenerateTutorialN, "Tutorial" },
+	{ &PuzzleList::GenerateSymmetryN, "Symmetry" },
+	{ &PuzzleList::GenerateQuarryN, "Quarry" },
+	//{ &PuzzleList::GenerateBunkerN, "Bunker" }, //Can't randomize because panels refuse to render the symbols
+	{ &PuzzleList::GenerateSwampN, "Swamp" },
+	{ &PuzzleList::GenerateTreehouseN, "Treehouse" },
+	{ &PuzzleList::GenerateTownN, "Town" },
+	{ &PuzzleList::GenerateVaultsN, "Vaults" },
+	{ &PuzzleList::GenerateTrianglePanelsN, "Triangles" },
+	{ &PuzzleList::GenerateOrchardN, "Orchard" },
+	{ &PuzzleList::GenerateDesertN, "Desert" },
+	{ &PuzzleList::GenerateKeepN, "Keep" },
+	{ &PuzzleList::GenerateJungleN, "Jungle" },
+	{ &PuzzleList::GenerateMountainN, "Mountain" },
+	{ &PuzzleList::GenerateCavesN, "Caves" },
+	//{ &PuzzleList::GenerateShadowsN, "Shadows" }, //Can't randomize
+	//{ &PuzzleList::GenerateMonasteryN, "Monastery" }, //Can't randomize
+};
+
+static const std::vector<AreaInfo> AreasH = {
+	{ &PuzzleList::GenerateTutorialH, "Tutorial" },
+	{ &PuzzleList::GenerateSymmetryH, "Symmetry" },
+	{ &PuzzleList::GenerateQuarryH, "Quarry" },
+	//{ &PuzzleList::GenerateBunkerH, "Bunker" }, //Can't randomize because panels refuse to render the symbols
+	{ &PuzzleList::GenerateSwampH, "Swamp" },
+	{ &PuzzleList::GenerateTreehouseH, "Treehouse" },
+	{ &PuzzleList::GenerateTownH, "Town" },
+	{ &PuzzleList::GenerateVaultsH, "Vaults" },
+	{ &PuzzleList::GenerateTrianglePanelsH, "Triangles" },
+	{ &PuzzleList::GenerateOrchardH, "Orchard" },
+	{ &PuzzleList::GenerateDesertH, "Desert" },
+	{ &PuzzleList::GenerateKeepH, "Keep" },
+	{ &PuzzleList::GenerateJungleH, "Jungle" },
+	{ &PuzzleList::GenerateMountainH, "Mountain" },
+	{ &PuzzleList::GenerateCavesH, "Caves" },
+	//{ &PuzzleList::GenerateShadowsH, "Shadows" }, //Can't randomize
+	//{ &PuzzleList::GenerateMonasteryH, "Monastery" }, //Can't randomize
+};
+
 void PuzzleList::GenerateAllN()
 {
 	generator->setLoadingData(336);
 	CopyTargets();
-	GenerateTutorialN();
-	GenerateSymmetryN();
-	GenerateQuarryN();
-	//GenerateBunkerN(); //Can't randomize because panels refuse to render the symbols
-	GenerateSwampN();
-	GenerateTreehouseN();
-	GenerateTownN();
-	GenerateVaultsN();
-	GenerateTrianglePanelsN();
-	GenerateOrchardN();
-	GenerateDesertN();
-	GenerateKeepN();
-	GenerateJungleN();
-	GenerateMountainN();
-	GenerateCavesN();
+	for (const AreaInfo& area : AreasN) RunArea(area.generate, area.name);
+	if (generator->profiler) generator->profiler->WriteCSV("WRPGprofile.csv");
 	SetWindowText(_handle, L"Done!");
 	(new ArrowWatchdog(0x0056E))->start(); //Easy way to close the randomizer when the game is done
-	//GenerateShadowsN(); //Can't randomize
-	//GenerateMonasteryN(); //Can't randomize
 }
 
 void PuzzleList::GenerateAllH()
 {
 	generator->setLoadingData(349);
 	CopyTargets();
-	GenerateTutorialH();
-	GenerateSymmetryH();
-	GenerateQuarryH();
-	//GenerateBunkerH(); //Can't randomize because panels refuse to render the symbols
-	GenerateSwampH();
-	GenerateTreehouseH();
-	GenerateTownH();
-	GenerateVaultsH();
-	GenerateTrianglePanelsH();
-	GenerateOrchardH();
-	GenerateDesertH();
-	GenerateKeepH();
-	GenerateJungleH();
-	GenerateMountainH();
-	GenerateCavesH();
+	for (const AreaInfo& area : AreasH) RunArea(area.generate, area.name);
+	if (generator->profiler) generator->profiler->WriteCSV("WRPGprofile.csv");
 	SetWindowText(_handle, L"Done!");
-	//GenerateShadowsH(); //Can't randomize
-	//GenerateMonasteryH(); //Can't randomize
+}
+
+//Generates every area as a separate job on a pool of numThreads threads. The areas don't share any panels, so the jobs don't depend on each other.
+//Each job has its own generator, drawing from counter-based streams keyed by the world seed and the panel (see Random::Counter), so the result is the same
+//however the jobs are scheduled (including on one thread). It is not the same as what GenerateAllN/H make for the seed, since there every panel
+//continues the random stream where the previous one left off. parallelAttempts - how many attempts at a panel each job runs at once (see Generate::retry)
+void PuzzleList::GenerateAreas(bool hard, int numThreads, int parallelAttempts)
+{
+	const std::vector<AreaInfo>& areas = hard ? AreasH : AreasN;
+	CopyTargets();
+	int worldSeed = (seed >= 0 ? seed : random->rand());
+	std::shared_ptr<Memory::Overlay> dryRun = Memory::GetDryRun();
+	std::vector<std::shared_ptr<WorldImage>> images(areas.size());
+	JobPool pool;
+	for (size_t i = 0; i < areas.size(); i++) {
+		std::shared_ptr<PuzzleList> job = std::make_shared<PuzzleList>(std::make_shared<Generate>(std::make_shared<Random>(worldSeed, Random::Counter)));
+		job->seed = seed;
+		job->seedIsRNG = seedIsRNG;
+		job->colorblind = colorblind;
+		job->generator->colorblind = colorblind;
+		job->generator->setParallelAttempts(parallelAttempts);
+		job->generator->setVerify(generator->_verify);
+		job->generator->profiler = generator->profiler;
+		job->generator->benchmark = generator->benchmark;
+		if (WorldImage::IsRecording()) images[i] = std::make_shared<WorldImage>(WorldImage::Key());
+		std::shared_ptr<WorldImage> image = images[i];
+		AreaInfo area = areas[i];
+		pool.Add([job, area, image, dryRun]() {
+			Memory::JoinDryRun(dryRun);
+			if (image) WorldImage::StartRecording(image);
+			try {
+				job->RunArea(area.generate, area.name);
+			}
+			catch (...) {
+				WorldImage::StopRecording();
+				Memory::JoinDryRun(nullptr);
+				throw;
+			}
+			WorldImage::StopRecording();
+			Memory::JoinDryRun(nullptr);
+		});
+	}
+	pool.Run(numThreads, [this](int finished, int total) {
+		std::wstring text = L"Generating: " + std::to_wstring(finished) + L"/" + std::to_wstring(total) + L" areas";
+		if (_handle) SetWindowText(_handle, text.c_str());
+	});
+	//Recorded in the order of the list, so the world image doesn't depend on the scheduling either
+	for (const std::shared_ptr<WorldImage>& image : images) {
+		if (image) WorldImage::RecordImage(*image);
+	}
+	if (generator->profiler) generator->profiler->WriteCSV("WRPGprofile.csv");
+	SetWindowText(_handle, L"Done!");
+	if (!hard) (new ArrowWatchdog(0x0056E))->start(); //Easy way to close the randomizer when the game is done
+}
+
+//Generates an area, timing it if a benchmark is running
+void PuzzleList::RunArea(Area area, const char* name)
+{
+	Benchmark::AreaTimer timer(generator->benchmark.get(), name);
+	(this->*area)();
 }
 
 void PuzzleList::CopyTargets()
@@ -676,7 +751,7 @@ void PuzzleList::GenerateMountainN()
 	std::set<Point> bpoints1 = { { 6, 3 },{ 5, 4 },{ 7, 4 } };
 	std::set<Point> bpoints2 = { { 6, 5 },{ 5, 6 },{ 6, 7 },{ 7, 6 } };
 	std::set<Point> bpoints3 = { { 3, 6 },{ 4, 7 } };
-	if (Random::rand() % 2 == 0) generator->hitPoints = { generator->pick_random(bpoints1), generator->pick_random(bpoints2), generator->pick_random(bpoints3) };
+	if (random->rand() % 2 == 0) generator->hitPoints = { generator->pick_random(bpoints1), generator->pick_random(bpoints2), generator->pick_random(bpoints3) };
 	else generator->hitPoints = { generator->pick_random(bpoints3), generator->pick_random(bpoints2), generator->pick_random(bpoints1) };
 	generator->setObstructions({ { 4, 1 },{ 6, 1 },{ 8, 1 } });
 	generator->blockPos = { { 1, 1 },{ 11, 1 },{ 1, 11 },{ 11, 11 } };
@@ -713,7 +788,7 @@ void PuzzleList::GenerateMountainN()
 	//Blue Row
 	generator->setObstructions({ { 4, 3 },{ 5, 4 },{ 5, 6 },{ 5, 8 },{ 5, 10 },{ 6, 9 },{ 7, 10 } });
 	generator->generate(0x33AF5, Decoration::Dot, 3, Decoration::Stone | Decoration::Color::Black, 4, Decoration::Stone | Decoration::Color::White, 4);
-	if (Random::rand() % 2 == 0) generator->setObstructions({ { 5, 4 },{ 5, 6 },{ 5, 8 },{ 5, 10 },{ 9, 4 },{ 9, 6 },{ 9, 8 },{ 9, 10 },{ 7, 0 },{ 7, 2 } });
+	if (random->rand() % 2 == 0) generator->setObstructions({ { 5, 4 },{ 5, 6 },{ 5, 8 },{ 5, 10 },{ 9, 4 },{ 9, 6 },{ 9, 8 },{ 9, 10 },{ 7, 0 },{ 7, 2 } });
 	else generator->setObstructions({ { 3, 4 },{ 3, 6 },{ 3, 8 },{ 3, 10 },{ 7, 4 },{ 7, 6 },{ 7, 8 },{ 7, 10 },{ 5, 0 },{ 5, 2 },{ 9, 0 },{ 9, 2 } });
 	generator->generate(0x33AF7, Decoration::Stone | Decoration::Color::Black, 7, Decoration::Stone | Decoration::Color::White, 5, Decoration::Star | Decoration::Color::Orange, 4);
 	generator->setObstructions({ { 0, 1 },{ 0, 3 },{ 0, 5 },{ 0, 7 },{ 9, 4 },{ 1, 4 },{ 1, 6 },{ 1, 8 },{ 2, 7 },{ 2, 9 },{ 3, 8 },{ 3, 10 },{ 4, 9 },{ 5, 8 },{ 5, 10 },
@@ -912,7 +987,7 @@ void PuzzleList::GenerateOrchardN()
 
 void PuzzleList::GenerateDesertN()
 {
-	Randomizer().RandomizeDesert();
+	Randomizer(random).RandomizeDesert();
 }
 
 void PuzzleList::GenerateKeepN()
@@ -952,7 +1027,7 @@ void PuzzleList::GenerateKeepN()
 	{ { 5, 8 },{ 3, 6 },{ 7, 2 },{ 3, 4 } },{ { 5, 8 },{ 1, 6 },{ 7, 2 },{ 1, 4 } },{ { 5, 8 },{ 4, 3 },{ 7, 2 },{ 2, 3 } },
 	{ { 5, 8 },{ 3, 4 },{ 7, 2 },{ 3, 2 } },{ { 5, 8 },{ 1, 4 },{ 7, 2 },{ 1, 2 } },{ { 5, 8 },{ 3, 2 },{ 7, 2 },{ 3, 0 } },
 	{ { 5, 8 },{ 1, 2 },{ 7, 2 },{ 1, 0 } } };
-	generator->hitPoints = validHitPoints[Random::rand() % validHitPoints.size()];
+	generator->hitPoints = validHitPoints[random->rand() % validHitPoints.size()];
 	generator->setFlagOnce(Generate::Config::DisableWrite);
 	generator->generate(0x01CD3, Decoration::Poly, 2, Decoration::Stone | Decoration::Color::Black, 1, Decoration::Stone | Decoration::Color::White, 1,
 		Decoration::Stone | Decoration::Color::Cyan, 1, Decoration::Stone | Decoration::Color::Magenta, 1);
@@ -990,11 +1065,11 @@ void PuzzleList::GenerateJungleN()
 	generator->resetConfig();
 
 	specialCase->generateSoundDotPuzzle(0x0026F, { 4, 4 }, { DOT_MEDIUM, DOT_MEDIUM, DOT_SMALL, DOT_MEDIUM, DOT_LARGE }, false);
-	if (Random::rand() % 2) specialCase->generateSoundDotPuzzle(0x00C3F, { 4, 4 }, { DOT_SMALL, DOT_MEDIUM, DOT_SMALL, DOT_LARGE }, true);
+	if (random->rand() % 2) specialCase->generateSoundDotPuzzle(0x00C3F, { 4, 4 }, { DOT_SMALL, DOT_MEDIUM, DOT_SMALL, DOT_LARGE }, true);
 	else specialCase->generateSoundDotPuzzle(0x00C3F, { 4, 4 }, { DOT_LARGE, DOT_MEDIUM, DOT_MEDIUM, DOT_SMALL, DOT_LARGE }, true);
-	if (Random::rand() % 2) specialCase->generateSoundDotPuzzle(0x00C41, { 4, 4 }, { DOT_SMALL, DOT_SMALL, DOT_LARGE, DOT_MEDIUM, DOT_LARGE }, true);
+	if (random->rand() % 2) specialCase->generateSoundDotPuzzle(0x00C41, { 4, 4 }, { DOT_SMALL, DOT_SMALL, DOT_LARGE, DOT_MEDIUM, DOT_LARGE }, true);
 	else specialCase->generateSoundDotPuzzle(0x00C41, { 4, 4 }, { DOT_MEDIUM, DOT_MEDIUM, DOT_SMALL, DOT_MEDIUM, DOT_LARGE }, true);
-	if (Random::rand() % 2) specialCase->generateSoundDotPuzzle(0x014B2, { 4, 4 }, { DOT_SMALL, DOT_LARGE, DOT_SMALL, DOT_LARGE, DOT_MEDIUM }, true);
+	if (random->rand() % 2) specialCase->generateSoundDotPuzzle(0x014B2, { 4, 4 }, { DOT_SMALL, DOT_LARGE, DOT_SMALL, DOT_LARGE, DOT_MEDIUM }, true);
 	else specialCase->generateSoundDotPuzzle(0x014B2, { 4, 4 }, { DOT_LARGE, DOT_MEDIUM, DOT_SMALL, DOT_LARGE, DOT_SMALL }, true);
 }
 
@@ -1164,7 +1239,7 @@ void PuzzleList::GenerateSymmetryH()
 	generator->setFlag(Generate::Config::DisableDotIntersection);
 	std::vector<int> ids = { 0x00065, 0x0006D, 0x00072, 0x0006F, 0x00070, 0x00071 };
 	std::vector<Panel::Symmetry> sym1 = { Panel::Symmetry::Vertical, Panel::Symmetry::Horizontal, Panel::Symmetry::Rotational, Panel::Symmetry::ParallelH, Panel::Symmetry::ParallelV };
-	std::vector<Panel::Symmetry> sym2 = { Panel::Symmetry::ParallelHFlip, Panel::Symmetry::ParallelVFlip, Random::rand() % 2 == 0 ? Panel::Symmetry::ParallelV : Panel::Symmetry::ParallelH };
+	std::vector<Panel::Symmetry> sym2 = { Panel::Symmetry::ParallelHFlip, Panel::Symmetry::ParallelVFlip, random->rand() % 2 == 0 ? Panel::Symmetry::ParallelV : Panel::Symmetry::ParallelH };
 	Panel::Symmetry lastChoice = Panel::Symmetry::None;
 	for (int i = 0; i < ids.size(); i++) {
 		Panel::Symmetry choice = (i < 4 ? pop_random(sym1) : pop_random(sym2));
@@ -1883,7 +1958,7 @@ void PuzzleList::GenerateMountainH()
 	std::set<Point> bpoints1 = { { 6, 3 },{ 5, 4 },{ 7, 4 } };
 	std::set<Point> bpoints2 = { { 6, 5 },{ 5, 6 },{ 6, 7 },{ 7, 6 } };
 	std::set<Point> bpoints3 = { { 3, 6 },{ 4, 7 } };
-	if (Random::rand() % 2 == 0) generator->hitPoints = { generator->pick_random(bpoints1), generator->pick_random(bpoints2), generator->pick_random(bpoints3) };
+	if (random->rand() % 2 == 0) generator->hitPoints = { generator->pick_random(bpoints1), generator->pick_random(bpoints2), generator->pick_random(bpoints3) };
 	else generator->hitPoints = { generator->pick_random(bpoints3), generator->pick_random(bpoints2), generator->pick_random(bpoints1) };
 	generator->setObstructions({ { 4, 1 },{ 6, 1 },{ 8, 1 } });
 	generator->blockPos = { { 3, 1 },{ 5, 1 },{ 7, 1 },{ 9, 1 },{ 1, 1 },{ 11, 1 },{ 1, 11 },{ 11, 11 } };
@@ -1947,7 +2022,7 @@ void PuzzleList::GenerateMountainH()
 	generator->setObstructions({ { 4, 3 },{ 5, 4 },{ 5, 6 },{ 5, 8 },{ 5, 10 },{ 6, 9 },{ 7, 10 } });
 	specialCase->initRotateGrid(generator);
 	generator->generate(0x33AF5, Decoration::Triangle | Decoration::Color::Orange, 2, Decoration::Stone | Decoration::Color::Black, 4, Decoration::Stone | Decoration::Color::White, 4);
-	if (Random::rand() % 2 == 0) generator->setObstructions({ { 5, 4 },{ 5, 6 },{ 5, 8 },{ 5, 10 },{ 9, 4 },{ 9, 6 },{ 9, 8 },{ 9, 10 },{ 7, 0 },{ 7, 2 } });
+	if (random->rand() % 2 == 0) generator->setObstructions({ { 5, 4 },{ 5, 6 },{ 5, 8 },{ 5, 10 },{ 9, 4 },{ 9, 6 },{ 9, 8 },{ 9, 10 },{ 7, 0 },{ 7, 2 } });
 	else generator->setObstructions({ { 3, 4 },{ 3, 6 },{ 3, 8 },{ 3, 10 },{ 7, 4 },{ 7, 6 },{ 7, 8 },{ 7, 10 },{ 5, 0 },{ 5, 2 },{ 9, 0 },{ 9, 2 } });
 	specialCase->initRotateGrid(generator);
 	generator->generate(0x33AF7, Decoration::Triangle | Decoration::Color::Orange, 2, Decoration::Star | Decoration::Color::Orange, 3);
@@ -2214,15 +2289,15 @@ void PuzzleList::GenerateCavesH()
 void PuzzleList::GenerateOrchardH()
 {
 	specialCase->generateApplePuzzle(0x00143, false, true);
-	specialCase->generateApplePuzzle(0x0003B, false, Random::rand() % 2 == 0);
-	specialCase->generateApplePuzzle(0x00055, false, Random::rand() % 2 == 0);
-	specialCase->generateApplePuzzle(0x032F7, false, Random::rand() % 2 == 0);
+	specialCase->generateApplePuzzle(0x0003B, false, random->rand() % 2 == 0);
+	specialCase->generateApplePuzzle(0x00055, false, random->rand() % 2 == 0);
+	specialCase->generateApplePuzzle(0x032F7, false, random->rand() % 2 == 0);
 	specialCase->generateApplePuzzle(0x032FF, true, true);
 }
 
 void PuzzleList::GenerateDesertH()
 {
-	Randomizer().RandomizeDesert();
+	Randomizer(random).RandomizeDesert();
 }
 
 void PuzzleList::GenerateKeepH()
@@ -2250,7 +2325,7 @@ void PuzzleList::GenerateKeepH()
 	std::vector<std::vector<Point>> validHitPoints = {
 		{ { 3, 4 },{ 7, 2 },{ 3, 2 } },{ { 4, 5 },{ 7, 2 },{ 2, 5 } },{ { 4, 3 },{ 7, 2 },{ 2, 3 } },
 	{ { 3, 4 },{ 7, 2 },{ 3, 2 } },{ { 1, 4 },{ 7, 2 },{ 1, 2 } },{ { 3, 2 },{ 7, 2 },{ 3, 0 } },{ { 1, 2 },{ 7, 2 },{ 1, 0 } } };
-	generator->hitPoints = validHitPoints[Random::rand() % validHitPoints.size()];
+	generator->hitPoints = validHitPoints[random->rand() % validHitPoints.size()];
 	generator->setObstructions({ { 5, 8 } });
 	generator->setFlagOnce(Generate::Config::SplitShapes);
 	generator->setFlagOnce(Generate::Config::DisableWrite);
@@ -2300,11 +2375,11 @@ void PuzzleList::GenerateJungleH()
 		{ DOT_MEDIUM, DOT_MEDIUM, DOT_SMALL, DOT_MEDIUM, DOT_LARGE }, 0, true);
 	specialCase->generateSoundDotReflectionPuzzle(0x00C3F, { 7, 7 }, { DOT_SMALL, DOT_MEDIUM, DOT_SMALL, DOT_LARGE },
 		{ DOT_LARGE, DOT_MEDIUM, DOT_MEDIUM, DOT_SMALL, DOT_LARGE }, 0, true);
-	if (Random::rand() % 2) specialCase->generateSoundDotReflectionPuzzle(0x00C41, { 7, 7 }, { DOT_SMALL, DOT_SMALL, DOT_LARGE, DOT_MEDIUM, DOT_LARGE },
+	if (random->rand() % 2) specialCase->generateSoundDotReflectionPuzzle(0x00C41, { 7, 7 }, { DOT_SMALL, DOT_SMALL, DOT_LARGE, DOT_MEDIUM, DOT_LARGE },
 		{ DOT_SMALL, DOT_SMALL, DOT_LARGE, DOT_MEDIUM, DOT_LARGE }, 0, true);
 	else specialCase->generateSoundDotReflectionPuzzle(0x00C41, { 7, 7 }, { DOT_MEDIUM, DOT_MEDIUM, DOT_SMALL, DOT_MEDIUM, DOT_LARGE },
 		{ DOT_MEDIUM, DOT_MEDIUM, DOT_SMALL, DOT_MEDIUM, DOT_LARGE }, 0, true);
-	switch (Random::rand() % 4) {
+	switch (random->rand() % 4) {
 	case 0: specialCase->generateSoundDotReflectionPuzzle(0x014B2, { 7, 7 }, { DOT_SMALL, DOT_LARGE, DOT_SMALL, DOT_LARGE, DOT_MEDIUM },
 		{ DOT_SMALL, DOT_LARGE, DOT_SMALL, DOT_LARGE, DOT_MEDIUM }, 0, true); break;
 	case 1: specialCase->generateSoundDotReflectionPuzzle(0x014B2, { 7, 7 }, { DOT_LARGE, DOT_MEDIUM, DOT_SMALL, DOT_LARGE, DOT_SMALL },
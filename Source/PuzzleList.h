@@ -2,22 +2,22 @@
 #include "Generate.h"
 #include "Special.h"
 #include "Random.h"
+#include "JobPool.h"
 
 class PuzzleList {
 
 public: 
 
+	typedef void (PuzzleList::*Area)();
+
 	void GenerateAllN();
 	void GenerateAllH();
-
-	PuzzleList() {
-		generator = std::make_shared<Generate>();
-		specialCase = std::make_shared<Special>(generator);
-	}
+	void GenerateAreas(bool hard, int numThreads, int parallelAttempts = 1);
 
 	PuzzleList(std::shared_ptr<Generate> generator) {
 		this->generator = generator;
 		this->specialCase = std::make_shared<Special>(generator);
+		this->random = generator->_random;
 	}
 
 	void setLoadingHandle(HWND handle) {
@@ -30,7 +30,7 @@ public:
 		this->seedIsRNG = isRNG;
 		this->colorblind = colorblind;
 		if (seed >= 0) generator->seed(seed);
-		else generator->seed(Random::rand());
+		else generator->seed(random->rand());
 		generator->colorblind = colorblind;
 	}
 
@@ -81,24 +81,27 @@ public:
 	void GenerateJungleH();
 
 private:
+	void RunArea(Area area, const char* name);
+
 	std::shared_ptr<Generate> generator;
 	std::shared_ptr<Special> specialCase;
+	std::shared_ptr<Random> random;
 	HWND _handle = nullptr;
 	int seed = 0;
 	bool seedIsRNG = false;
 	bool colorblind = false;
 
-	template <class T> T pick_random(std::vector<T>& vec) { return vec[Random::rand() % vec.size()]; }
-	template <class T> T pick_random(std::set<T>& set) { auto it = set.begin(); std::advance(it, Random::rand() % set.size()); return *it; }
+	template <class T> T pick_random(std::vector<T>& vec) { return vec[random->rand() % vec.size()]; }
+	template <class T> T pick_random(std::set<T>& set) { auto it = set.begin(); std::advance(it, random->rand() % set.size()); return *it; }
 	template <class T> T pop_random(std::vector<T>& vec) {
-		int i = Random::rand() % vec.size();
+		int i = random->rand() % vec.size();
 		T item = vec[i];
 		vec.erase(vec.begin() + i);
 		return item;
 	}
 	template <class T> T pop_random(std::set<T>& set) {
 		auto it = set.begin();
-		std::advance(it, Random::rand() % set.size());
+		std::advance(it, random->rand() % set.size());
 		T item = *it;
 		set.erase(item);
 		return item;
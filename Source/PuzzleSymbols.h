@@ -14,16 +14,16 @@ struct PuzzleSymbols {
 		return total;
 	}
 	bool any(int symbolType) { return symbols[symbolType].size() > 0; }
-	int popRandomSymbol() {
+	int popRandomSymbol(Random& random) {
 		std::vector<int> types;
 		for (auto& pair : symbols)
 			if (pair.second.size() > 0 && pair.first != Decoration::Start && pair.first != Decoration::Exit && pair.first != Decoration::Gap && pair.first != Decoration::Eraser)
 				types.push_back(pair.first);
-		int randType = types[Random::rand() % types.size()];
-		int randIndex = Random::rand() % symbols[randType].size();
+		int randType = types[random.rand() % types.size()];
+		int randIndex = random.rand() % symbols[randType].size();
 		while (symbols[randType][randIndex].second == 0 || symbols[randType][randIndex].second >= 25) {
-			randType = types[Random::rand() % types.size()];
-			randIndex = Random::rand() % symbols[randType].size();
+			randType = types[random.rand() % types.size()];
+			randIndex = random.rand() % symbols[randType].size();
 		}
 		symbols[randType][randIndex].second--;
 		return symbols[randType][randIndex].first;
@@ -1,17 +1,61 @@
 #pragma once
 #include <random>
+#include <map>
+#include <stdint.h>
 #include <stdlib.h>
 
-struct Random {
+//Random number stream for one run of the generators. Everything taking part in the run (Generate, MultiGenerate, Special, PuzzleSymbols, PuzzleList and the panel shuffles)
+//draws from the same instance. Generators running on different threads must each have their own.
+class Random {
 
-	static std::mt19937 gen;
+public:
+	enum Mode {
+		Sequential, //One mt19937 stream for the whole run, reseeded by the generators between panels. The puzzles for a seed depend on everything generated before them (as in earlier versions)
+		Counter, //Every generation attempt of a panel gets its own counter-based stream, keyed by (seed, panel id, attempt), so the result for a panel doesn't depend on the panels before it
+	};
 
-	static void seed(int val) {
-		gen = std::mt19937(val);
+	Random(); //Sequential, seeded from the current time
+	Random(int val) { seed(val); }
+	Random(int val, Mode mode) { _mode = mode; _seed = val; seed(val); key(0, 0, WorldStream); }
+
+	//In counter mode the streams only depend on the seed given to the constructor, so this does nothing
+	void seed(int val) {
+		if (_mode == Sequential) gen = std::mt19937(val);
 	}
 
-	static int rand() {
-		return abs((int)gen());
+	int rand() {
+		if (_mode == Sequential) return abs((int)gen());
+		return static_cast<int>(mix(_stream + ++_counter * 0x9E3779B97F4A7C15ull) >> 33);
 	}
 
+	Mode mode() const { return _mode; }
+
+	//Counter mode only - start the stream for the next attempt at a panel, or the stream used after the panel has been written (until the next one starts)
+	void startPanel(int panel) { if (_mode == Counter) key(panel, _attempts[panel]++, Attempt); }
+	void finishPanel(int panel) { if (_mode == Counter) key(panel, _writes[panel]++, Written); }
+
+	//Counter mode only - the index of the attempt the next startPanel for the panel will start, and skipping to a given one (used to run attempts on copies, see Generate::retry)
+	int nextAttempt(int panel) const { auto it = _attempts.find(panel); return it == _attempts.end() ? 0 : it->second; }
+	void setAttempt(int panel, int attempt) { _attempts[panel] = attempt; }
+
+private:
+	enum Phase { WorldStream, Attempt, Written };
+
+	//SplitMix64 finalizer
+	static uint64_t mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+	void key(int panel, int index, Phase phase) {
+		_stream = mix(mix(mix(static_cast<uint64_t>(static_cast<uint32_t>(_seed)) << 2 | phase) + static_cast<uint32_t>(panel)) + static_cast<uint32_t>(index));
+		_counter = 0;
+	}
+
+	Mode _mode = Sequential;
+	std::mt19937 gen;
+	int _seed = 0;
+	uint64_t _stream = 0, _counter = 0;
+	std::map<int, int> _attempts, _writes;
+
 };
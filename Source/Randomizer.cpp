@@ -24,24 +24,293 @@ std::vector<int> copyWithoutElements(const std::vector<int>& input, const std::v
 }
 
 void Randomizer::GenerateNormal(HWND loadingHandle) {
-	std::shared_ptr<PuzzleList> puzzles = std::make_shared<PuzzleList>();
+	WorldImage::StartRecording(std::make_shared<WorldImage>(GetWorldKey(false)));
+	Panel::ClearPalettes();
+	std::shared_ptr<Generate> generator = std::make_shared<Generate>(_random);
+	generator->setVerify(verify);
+	if (profile) generator->profiler = std::make_shared<Profiler>();
+	generator->benchmark = _benchmark;
+	std::shared_ptr<PuzzleList> puzzles = std::make_shared<PuzzleList>(generator);
 	puzzles->setLoadingHandle(loadingHandle);
 	puzzles->setSeed(seed, seedIsRNG, colorblind);
-	puzzles->GenerateAllN();
+	if (threads > 0) puzzles->GenerateAreas(false, threads, parallelAttempts);
+	else puzzles->GenerateAllN();
 	if (doubleMode) ShufflePanels(false);
+	worldImage = WorldImage::StopRecording();
 }
 
 void Randomizer::GenerateHard(HWND loadingHandle) {
-	std::shared_ptr<PuzzleList> puzzles = std::make_shared<PuzzleList>();
+	WorldImage::StartRecording(std::make_shared<WorldImage>(GetWorldKey(true)));
+	Panel::ClearPalettes();
+	std::shared_ptr<Generate> generator = std::make_shared<Generate>(_random);
+	generator->setVerify(verify);
+	if (profile) generator->profiler = std::make_shared<Profiler>();
+	generator->benchmark = _benchmark;
+	std::shared_ptr<PuzzleList> puzzles = std::make_shared<PuzzleList>(generator);
 	puzzles->setLoadingHandle(loadingHandle);
 	puzzles->setSeed(seed, seedIsRNG, colorblind);
-	puzzles->GenerateAllH();
+	if (threads > 0) puzzles->GenerateAreas(true, threads, parallelAttempts);
+	else puzzles->GenerateAllH();
 	if (doubleMode) ShufflePanels(true);
 	SetWindowText(loadingHandle, L"Starting watchdogs...");
 	Panel::StartArrowWatchdogs(_shuffleMapping);
 	SetWindowText(loadingHandle, L"Done!");
-	if (!Special::hasBeenRandomized())
-		MessageBox(GetActiveWindow(), L"Hi there! Thanks for trying out Expert Mode. It will be tough, but I hope you have fun!\r\n\r\n"
+	worldImage = WorldImage::StopRecording();
+	if (!Special::hasBeenRandomized() && !Memory::IsDryRun()) ShowExpertWelcome();
+}
+
+//Skips generation entirely by replaying everything written while generating the image
+void Randomizer::ApplyWorldImage(std::shared_ptr<WorldImage> image, HWND loadingHandle) {
+	SetWindowText(loadingHandle, L"Loading puzzles...");
+	image->Apply(_memory);
+	worldImage = image;
+	SetWindowText(loadingHandle, L"Done!");
+	if (image->key.hard && !Special::hasBeenRandomized()) ShowExpertWelcome();
+}
+
+WorldImage::Key Randomizer::GetWorldKey(bool hard) {
+	WorldImage::Key key;
+	key.seed = seed;
+	key.hard = hard;
+	key.doubleMode = doubleMode;
+	key.colorblind = colorblind;
+	key.randomSeed = seedIsRNG;
+	key.streams = threads > 0 ? Random::Counter : Random::Sequential; //The number of threads doesn't matter
+	key.verified = verify;
+	return key;
+}
+
+//Generates the worlds for a range of seeds into the world cache, without changing anything in the game. Returns the number of worlds added.
+int Randomizer::PregenerateWorlds(int firstSeed, int lastSeed, bool hard) {
+	int numGenerated = 0;
+	seedIsRNG = false;
+	for (seed = firstSeed; seed <= lastSeed; seed++) {
+		if (WorldImage::LoadCached(GetWorldKey(hard))) continue;
+		_shuffleMapping.clear();
+		Panel::ClearGeneratedPanels();
+		Memory::StartDryRun();
+		try {
+			if (hard) GenerateHard(nullptr);
+			else GenerateNormal(nullptr);
+		}
+		catch (std::exception) {
+			WorldImage::StopRecording();
+			worldImage = nullptr;
+		}
+		Memory::StopDryRun();
+		ClearOffsets();
+		if (worldImage && worldImage->SaveCached()) numGenerated++;
+	}
+	return numGenerated;
+}
+
+//Benchmark for the solution counts that keep the mazes unambiguous - generates the tutorial for a range of seeds without changing anything in the game,
+//and writes the number of solutions of every maze made (capped at 2) and the time taken to count them into a CSV file.
+bool Randomizer::CountMazeSolutions(int firstSeed, int lastSeed, const std::string& filename) {
+	std::ofstream file(filename, std::ofstream::trunc);
+	if (!file) return false;
+	file << "seed,panel,solutions,microseconds" << std::endl;
+	for (int s = firstSeed; s <= lastSeed; s++) {
+		Panel::ClearGeneratedPanels();
+		Memory::StartDryRun();
+		std::shared_ptr<Generate> generator = std::make_shared<Generate>(_random);
+		generator->setVerify(verify);
+		generator->solutionCounts = std::make_shared<std::vector<Generate::SolutionCount>>();
+		PuzzleList puzzles(generator);
+		puzzles.setSeed(s, false, colorblind);
+		try {
+			puzzles.GenerateTutorialN();
+		}
+		catch (std::exception) { }
+		Memory::StopDryRun();
+		ClearOffsets();
+		for (const Generate::SolutionCount& count : *generator->solutionCounts) {
+			file << s << ",0x" << std::hex << std::setw(5) << std::setfill('0') << count.id << std::dec << "," << count.solutions << "," << count.microseconds << std::endl;
+		}
+	}
+	return file.good();
+}
+
+//Generates the worlds for a range of seeds without changing anything in the game, and writes how long the worlds, areas and panels took into a JSON file
+//(see Benchmark). Nothing is taken from or added to the world cache.
+bool Randomizer::BenchmarkWorlds(int firstSeed, int lastSeed, bool hard, const std::string& filename) {
+	_benchmark = std::make_shared<Benchmark>();
+	seedIsRNG = false;
+	for (seed = firstSeed; seed <= lastSeed; seed++) {
+		_shuffleMapping.clear();
+		Panel::ClearGeneratedPanels();
+		Memory::StartDryRun();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		try {
+			if (hard) GenerateHard(nullptr);
+			else GenerateNormal(nullptr);
+			_benchmark->AddWorld(Benchmark::Since(start));
+		}
+		catch (std::exception) {
+			WorldImage::StopRecording();
+			_benchmark->DiscardWorld();
+		}
+		worldImage = nullptr;
+		Memory::StopDryRun();
+		ClearOffsets();
+	}
+	std::string config = std::string(hard ? "expert" : "normal") + " seeds=" + std::to_string(firstSeed) + "-" + std::to_string(lastSeed) +
+		" threads=" + std::to_string(threads) + " attempts=" + std::to_string(parallelAttempts) + (verify ? " verify" : "") + (doubleMode ? " double" : "");
+	bool written = _benchmark->WriteJSON(filename, config);
+	_benchmark = nullptr;
+	return written;
+}
+
+//Generates a world with the current settings without changing anything in the game. Returns nullptr if generation failed
+std::shared_ptr<WorldImage> Randomizer::GenerateDryRun(bool hard) {
+	_shuffleMapping.clear();
+	Panel::ClearGeneratedPanels();
+	Memory::StartDryRun();
+	try {
+		if (hard) GenerateHard(nullptr);
+		else GenerateNormal(nullptr);
+	}
+	catch (std::exception) {
+		WorldImage::StopRecording();
+		worldImage = nullptr;
+	}
+	Memory::StopDryRun();
+	ClearOffsets();
+	std::shared_ptr<WorldImage> image = worldImage;
+	worldImage = nullptr;
+	return image;
+}
+
+//Adds a line to the report for every panel written differently (see WorldImage::PanelHashes)
+static void ComparePanelHashes(std::ostream& report, const std::string& name, const std::map<int, unsigned long long>& expected, const std::map<int, unsigned long long>& actual) {
+	std::set<int> panels;
+	for (const std::pair<const int, unsigned long long>& entry : expected) panels.insert(entry.first);
+	for (const std::pair<const int, unsigned long long>& entry : actual) panels.insert(entry.first);
+	for (int panel : panels) {
+		auto e = expected.find(panel), a = actual.find(panel);
+		if (e != expected.end() && a != actual.end() && e->second == a->second) continue;
+		report << name << ": panel 0x" << std::hex << std::setw(5) << std::setfill('0') << panel << std::dec << std::setfill(' ') <<
+			(e == expected.end() ? " is new" : a == actual.end() ? " is no longer written" : " diverged") << std::endl;
+	}
+}
+
+//Checks that a seed always gives the same world - generates each seed twice one area after another, then with one thread and with 16 threads (which
+//must match, see GenerateAreas), and reports every panel that came out differently. Generators that don't draw from the seeded streams show up here.
+std::string Randomizer::CheckDeterminism(int firstSeed, int lastSeed, bool hard) {
+	std::stringstream report;
+	seedIsRNG = false;
+	int savedThreads = threads, savedAttempts = parallelAttempts;
+	for (int s = firstSeed; s <= lastSeed; s++) {
+		std::string name = std::string(hard ? "expert " : "normal ") + std::to_string(s);
+		std::map<int, unsigned long long> hashes[4];
+		const int threadCounts[4] = { 0, 0, 1, 16 };
+		for (int i = 0; i < 4; i++) {
+			seed = s;
+			threads = threadCounts[i];
+			parallelAttempts = (threads > 1 ? 4 : 1);
+			std::shared_ptr<WorldImage> image = GenerateDryRun(hard);
+			if (image) hashes[i] = image->PanelHashes();
+			else report << name << ": generation failed with " << threads << " threads" << std::endl;
+		}
+		ComparePanelHashes(report, name + " (second run)", hashes[0], hashes[1]);
+		ComparePanelHashes(report, name + " (16 threads)", hashes[2], hashes[3]);
+	}
+	threads = savedThreads;
+	parallelAttempts = savedAttempts;
+	return report.str();
+}
+
+//Regression check for the puzzles produced for a seed - generates the worlds listed in a golden hash file without changing anything in the game, and compares
+//the hash of everything written to each panel (see WorldImage::PanelHashes) with the one stored in the file. With record, the file is rewritten with the
+//current hashes instead. Returns what went wrong, listing every panel that diverged, or an empty string if nothing did.
+//File format - "world <normal|expert> <seed> [double] [colorblind] [threads] [verify]" followed by one "<panel> <hash>" line per panel, # for comments.
+std::string Randomizer::CheckGoldenHashes(const std::string& filename, bool record) {
+	struct GoldenWorld {
+		std::string spec;
+		bool hard = false;
+		int seed = 0;
+		bool doubleMode = false, colorblind = false, threads = false, verify = false;
+		std::map<int, unsigned long long> hashes;
+	};
+	std::vector<std::string> comments;
+	std::vector<GoldenWorld> worlds;
+	std::ifstream in(filename);
+	if (!in) return "Couldn't read " + filename + ".";
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.size() > 0 && line.back() == '\r') line.pop_back();
+		std::stringstream ss(line);
+		std::string word;
+		if (!(ss >> word) || word[0] == '#') {
+			if (worlds.size() == 0) comments.push_back(line);
+			continue;
+		}
+		if (word == "world") {
+			GoldenWorld world;
+			std::string mode;
+			if (!(ss >> mode >> world.seed) || (mode != "normal" && mode != "expert")) return "Bad world in " + filename + ": " + line;
+			world.hard = (mode == "expert");
+			world.spec = mode + " " + std::to_string(world.seed);
+			while (ss >> word) {
+				if (word == "double") world.doubleMode = true;
+				else if (word == "colorblind") world.colorblind = true;
+				else if (word == "threads") world.threads = true;
+				else if (word == "verify") world.verify = true;
+				else return "Bad world in " + filename + ": " + line;
+				world.spec += " " + word;
+			}
+			worlds.push_back(world);
+			continue;
+		}
+		unsigned long long hash;
+		if (worlds.size() == 0 || !(ss >> std::hex >> hash)) return "Bad line in " + filename + ": " + line;
+		worlds.back().hashes[std::stoi(word, nullptr, 16)] = hash;
+	}
+	in.close();
+	if (worlds.size() == 0) return "No worlds listed in " + filename + ".";
+	if (!record && std::all_of(worlds.begin(), worlds.end(), [](const GoldenWorld& world) { return world.hashes.size() == 0; }))
+		return "No golden hashes have been recorded in " + filename + " yet. Record them from a known good build with -golden " + filename + " -record.";
+
+	std::stringstream report;
+	seedIsRNG = false;
+	for (GoldenWorld& world : worlds) {
+		seed = world.seed;
+		doubleMode = world.doubleMode;
+		colorblind = world.colorblind;
+		threads = world.threads ? 4 : 0; //Any number of threads gives the same world
+		verify = world.verify;
+		std::shared_ptr<WorldImage> image = GenerateDryRun(world.hard);
+		if (!image) {
+			report << world.spec << ": generation failed" << std::endl;
+			continue;
+		}
+		std::map<int, unsigned long long> hashes = image->PanelHashes();
+		if (record) {
+			world.hashes = hashes;
+			continue;
+		}
+		if (world.hashes.size() == 0) {
+			report << world.spec << ": no golden hashes recorded" << std::endl;
+			continue;
+		}
+		ComparePanelHashes(report, world.spec, world.hashes, hashes);
+	}
+	if (!record) return report.str();
+
+	std::ofstream out(filename, std::ofstream::trunc);
+	for (const std::string& comment : comments) out << comment << std::endl;
+	for (const GoldenWorld& world : worlds) {
+		out << "world " << world.spec << std::endl;
+		for (const std::pair<const int, unsigned long long>& entry : world.hashes) {
+			out << "0x" << std::hex << std::setw(5) << std::setfill('0') << entry.first << " " << std::setw(16) << entry.second << std::dec << std::setfill(' ') << std::endl;
+		}
+	}
+	if (!out.good()) report << "Couldn't write " << filename << "." << std::endl;
+	return report.str();
+}
+
+void Randomizer::ShowExpertWelcome() {
+	MessageBox(GetActiveWindow(), L"Hi there! Thanks for trying out Expert Mode. It will be tough, but I hope you have fun!\r\n\r\n"
 		L"Expert has some unique tricks up its sleeve. You will encounter some situations that may seem impossible at first glance. "
 		L"In these situations, try to think of alternate approaches that weren't required in the base game.\r\n\r\n"
 		L"For especially tough puzzles, the Solver folder has a solver that works for most puzzles, though it currently has some trouble with Erasers.\r\n\r\n"
@@ -81,7 +350,7 @@ void Randomizer::RandomizeDesert() {
 	std::vector<int> validSurfaceSeven = { 0x00698, 0x0048F, 0x09F92, 0x0A036, 0x0A049, 0x0A053, 0x00422, 0x006E3, 0x0A02D, 0x00C72, 0x0129D, 0x008BB, 0x0078D, 0x18313, 0x04D18, 0x01205, 0x181AB, 0x17ECA, 0x012D7 };
 	int endIndex = static_cast<int>(desertPanels.size());
 	for (int i = 0; i < endIndex - 1; i++) {
-		const int target = Random::rand() % (endIndex - i) + i;
+		const int target = _random->rand() % (endIndex - i) + i;
 		//Prevent ambiguity caused by shadows, and ensure all latches on Surface 7 and Light 3 must be opened
 		if (i == target || i == 1 && std::find(valid1.begin(), valid1.end(), desertPanels[target]) == valid1.end() || 
 			(i == 2 || i == 9) && std::find(valid2.begin(), valid2.end(), desertPanels[target]) == valid2.end() ||
@@ -119,7 +388,7 @@ void Randomizer::RandomizeRange(std::vector<int> panels, int flags, size_t start
 	if (startIndex >= endIndex) return;
 	if (endIndex >= panels.size()) endIndex = static_cast<int>(panels.size());
 	for (size_t i = endIndex - 1; i > startIndex; i--) {
-		const int target = (Random::rand() % (static_cast<int>(i) - static_cast<int>(startIndex) + 1)) + static_cast<int>(startIndex);
+		const int target = (_random->rand() % (static_cast<int>(i) - static_cast<int>(startIndex) + 1)) + static_cast<int>(startIndex);
 		if (i != target) {
 			SwapPanels(panels[i], panels[target], flags);
 			std::swap(panels[i], panels[target]); // Panel indices in the array
@@ -215,7 +484,10 @@ void Randomizer::SwapPanels(int panel1, int panel2, int flags) {
 		offsets[SPECULAR_TEXTURE] = sizeof(void*);
 	}
 
+	//Some of the swapped fields are pointers into the game's memory, so the swap itself is recorded rather than the bytes written
+	WorldImage::RecordSwap(panel1, panel2, offsets);
 	for (auto const&[offset, size] : offsets) {
+		WorldImage::Pause pause;
 		std::vector<byte> panel1data = _memory->ReadPanelData<byte>(panel1, offset, size);
 		std::vector<byte> panel2data = _memory->ReadPanelData<byte>(panel2, offset, size);
 		_memory->WritePanelData<byte>(panel2, offset, panel1data);
@@ -246,7 +518,7 @@ void Randomizer::ReassignTargets(const std::vector<int>& panels, const std::vect
 void Randomizer::SwapWithRandomPanel(int panel1, const std::vector<int>& possiblePanels, int flags) {
 	int toSwap = -1;
 	do {
-		const int target = Random::rand() % static_cast<int>(possiblePanels.size());
+		const int target = _random->rand() % static_cast<int>(possiblePanels.size());
 		toSwap = possiblePanels[target];
 	} while (_alreadySwapped.count(toSwap));
 	if (panel1 != toSwap) {
@@ -261,7 +533,7 @@ void Randomizer::ShuffleRange(std::vector<int>& order, size_t startIndex, size_t
 	if (startIndex >= endIndex) return;
 	if (endIndex >= order.size()) endIndex = static_cast<int>(order.size());
 	for (size_t i = endIndex - 1; i > startIndex; i--) {
-		const int target = (Random::rand() % (static_cast<int>(i) - static_cast<int>(startIndex) + 1)) + static_cast<int>(startIndex); 
+		const int target = (_random->rand() % (static_cast<int>(i) - static_cast<int>(startIndex) + 1)) + static_cast<int>(startIndex); 
 		std::swap(order[i], order[target]);
 	}
 }
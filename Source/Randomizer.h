@@ -1,13 +1,25 @@
 #pragma once
 #include "Memory.h"
+#include "Random.h"
+#include "Benchmark.h"
 #include <memory>
 #include <set>
 #include <map>
 
 class Randomizer {
 public:
+	Randomizer() : Randomizer(std::make_shared<Random>()) { }
+	Randomizer(std::shared_ptr<Random> random) { _random = random; }
+
 	void GenerateNormal(HWND loadingHandle);
 	void GenerateHard(HWND loadingHandle);
+	void ApplyWorldImage(std::shared_ptr<WorldImage> image, HWND loadingHandle);
+	WorldImage::Key GetWorldKey(bool hard);
+	int PregenerateWorlds(int firstSeed, int lastSeed, bool hard);
+	bool CountMazeSolutions(int firstSeed, int lastSeed, const std::string& filename);
+	bool BenchmarkWorlds(int firstSeed, int lastSeed, bool hard, const std::string& filename);
+	std::string CheckGoldenHashes(const std::string& filename, bool record);
+	std::string CheckDeterminism(int firstSeed, int lastSeed, bool hard);
 
 	void AdjustSpeed();
 
@@ -25,8 +37,15 @@ public:
 	bool seedIsRNG = false;
 	bool colorblind = false;
 	bool doubleMode = false;
+	int threads = 0; //Generate the areas as parallel jobs on this many threads (see PuzzleList::GenerateAreas). 0 - one after another, as in earlier versions
+	int parallelAttempts = 1; //With threads > 0, how many attempts at a panel are run at once (see Generate::retry). Doesn't change the puzzles
+	bool verify = false; //Check every panel with the Solver and generate it again if it can't be solved (see Generate::setVerify)
+	bool profile = false; //Write where the generator spent its time on each panel to WRPGprofile.csv once done (see Profiler)
+	std::shared_ptr<WorldImage> worldImage; //Everything written into the game by the last randomization
 
 private:
+	std::shared_ptr<WorldImage> GenerateDryRun(bool hard);
+	void ShowExpertWelcome();
 	void RandomizeDesert();
 
 	void Randomize(std::vector<int>& panels, int flags);
@@ -41,6 +60,8 @@ private:
 	std::shared_ptr<Memory> _memory = std::make_shared<Memory>("witness64_d3d11.exe");
 	std::set<int> _alreadySwapped;
 	std::map<int, int> _shuffleMapping;
+	std::shared_ptr<Random> _random; //The generators' random stream, so that the shuffles continue where the generators left off
+	std::shared_ptr<Benchmark> _benchmark; //Set while BenchmarkWorlds is running
 
 	friend class Panel;
 	friend class PuzzleList;
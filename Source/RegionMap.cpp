@@ -0,0 +1,218 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "RegionMap.h"
+#include "Bitboard.h"
+#include <algorithm>
+
+void RegionMap::build(const std::vector<std::vector<int>>& grid, int width, int height, int pillarWidth)
+{
+	_grid = &grid;
+	_width = width;
+	_height = height;
+	_pillarWidth = pillarWidth;
+	_parent.resize(width * height);
+	for (int i = 0; i < width * height; i++) _parent[i] = i;
+	_labels.assign(width * height, -1);
+	_regions.clear();
+	_counts.clear();
+	_unlabeled.clear();
+
+	//Join every block with the blocks to its right and below it, where the edge between them can be crossed
+	for (int x = 1; x < width; x += 2) {
+		for (int y = 1; y < height; y += 2) {
+			if ((grid[x][y] & Decoration::Empty) == Decoration::Empty) continue;
+			for (Point dir : { Point(1, 0), Point(0, 1) }) {
+				Point edge = (Point(x, y) + dir).wrap(pillarWidth);
+				if (!crossable(grid, width, height, pillarWidth, edge)) continue;
+				Point next = (edge + dir).wrap(pillarWidth);
+				if (next.first >= width || next.second >= height || (grid[next.first][next.second] & Decoration::Empty) == Decoration::Empty) continue;
+				int a = find(x * height + y), b = find(next.first * height + next.second);
+				if (a < b) _parent[b] = a;
+				else if (b < a) _parent[a] = b;
+			}
+		}
+	}
+	//Number the regions in the order their first block is reached going by x, then y, so the member lists come out sorted
+	std::vector<int> rootLabel(width * height, -1);
+	for (int x = 1; x < width; x += 2) {
+		for (int y = 1; y < height; y += 2) {
+			if ((grid[x][y] & Decoration::Empty) == Decoration::Empty) continue;
+			int root = find(x * height + y);
+			if (rootLabel[root] == -1) {
+				rootLabel[root] = static_cast<int>(_regions.size());
+				_regions.emplace_back();
+			}
+			_labels[x * height + y] = rootLabel[root];
+			_regions[rootLabel[root]].push_back(Point(x, y));
+		}
+	}
+}
+
+const std::vector<Point>& RegionMap::region(Point pos)
+{
+	int l = label(pos);
+	if (l >= 0) return _regions[l];
+	auto it = _unlabeled.find(pos);
+	if (it == _unlabeled.end()) {
+		std::set<Point> region = Flood(*_grid, _width, _height, _pillarWidth, pos);
+		it = _unlabeled.emplace(pos, std::vector<Point>(region.begin(), region.end())).first;
+	}
+	return it->second;
+}
+
+bool RegionMap::same(Point pos1, Point pos2)
+{
+	int l = label(pos1);
+	if (l >= 0) return l == label(pos2);
+	const std::vector<Point>& members = region(pos1);
+	return std::binary_search(members.begin(), members.end(), pos2);
+}
+
+void RegionMap::countSymbols()
+{
+	_counts.assign(_regions.size(), ColorCounts());
+	for (int i = 0; i < _regions.size(); i++) {
+		for (Point p : _regions[i]) count(_counts[i], (*_grid)[p.first][p.second], 1);
+	}
+}
+
+void RegionMap::update(Point pos, int oldValue, int newValue)
+{
+	if (_counts.size() == 0) return;
+	int l = label(pos);
+	if (l < 0) return;
+	count(_counts[l], oldValue, -1);
+	count(_counts[l], newValue, 1);
+}
+
+const RegionMap::ColorCounts* RegionMap::counts(Point pos) const
+{
+	if (_counts.size() == 0) return nullptr;
+	int l = label(pos);
+	return l >= 0 ? &_counts[l] : nullptr;
+}
+
+void RegionMap::count(ColorCounts& counts, int value, int amount)
+{
+	if (value == 0) return;
+	int color = value & 0xf;
+	counts.symbols[color] += amount;
+	if ((value & ~0xf) == Decoration::Star) counts.stars[color] += amount;
+	if ((value & 0x700) == Decoration::Stone) {
+		counts.stones[color] += amount;
+		counts.numStones += amount;
+	}
+}
+
+std::set<Point> RegionMap::Flood(const std::vector<std::vector<int>>& grid, int width, int height, int pillarWidth, Point pos)
+{
+	std::set<Point> region;
+	std::vector<Point> check;
+	check.push_back(pos);
+	region.insert(pos);
+	while (check.size() > 0) {
+		Point p = check[check.size() - 1];
+		check.pop_back();
+		for (Point dir : { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0) }) {
+			Point p1 = (p + dir).wrap(pillarWidth);
+			if (!crossable(grid, width, height, pillarWidth, p1)) continue;
+			Point p2 = (p + dir * 2).wrap(pillarWidth);
+			if ((grid[p2.first][p2.second] & Decoration::Empty) == Decoration::Empty) continue;
+			if (region.insert(p2).second) {
+				check.push_back(p2);
+			}
+		}
+	}
+	return region;
+}
+
+int RegionMap::Splits(const std::vector<std::vector<int>>& grid, int width, int height, int pillarWidth, const std::vector<Point>& edges, std::vector<int>* sizesBefore, std::vector<int>* sizesAfter)
+{
+	//The blocks on both sides of each edge. Removing edges can only split the regions they were in, and every part of a split region touches one of them
+	std::vector<Point> sides;
+	std::vector<std::pair<int, int>> joined;
+	for (Point edge : edges) {
+		Point dir = (edge.first % 2 == 0 ? Point(1, 0) : Point(0, 1));
+		Point a = (edge + dir * -1).wrap(pillarWidth), b = (edge + dir).wrap(pillarWidth);
+		if (!isBlock(grid, width, height, a) || !isBlock(grid, width, height, b)) continue;
+		int indices[2];
+		for (int i = 0; i < 2; i++) {
+			Point p = (i == 0 ? a : b);
+			indices[i] = static_cast<int>(std::find(sides.begin(), sides.end(), p) - sides.begin());
+			if (indices[i] == sides.size()) sides.push_back(p);
+		}
+		joined.emplace_back(indices[0], indices[1]);
+	}
+	//Group the sides by the region they are in now
+	std::vector<int> component(sides.size(), -1);
+	std::vector<int> sizes;
+	int after = 0;
+	for (int i = 0; i < sides.size(); i++) {
+		if (component[i] != -1) continue;
+		Bitboard region;
+		std::vector<Point> check = { sides[i] };
+		region.insert(sides[i]);
+		while (check.size() > 0) {
+			Point p = check[check.size() - 1];
+			check.pop_back();
+			for (Point dir : { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0) }) {
+				if (!crossable(grid, width, height, pillarWidth, (p + dir).wrap(pillarWidth))) continue;
+				Point p2 = (p + dir * 2).wrap(pillarWidth);
+				if (isBlock(grid, width, height, p2) && region.insert(p2)) check.push_back(p2);
+			}
+		}
+		for (int j = i; j < sides.size(); j++) {
+			if (region.count(sides[j])) component[j] = after;
+		}
+		sizes.push_back(static_cast<int>(region.size()));
+		after++;
+	}
+	//Before, the two sides of each edge were in the same region
+	std::vector<int> parent(after);
+	for (int i = 0; i < after; i++) parent[i] = i;
+	auto root = [&](int c) { while (parent[c] != c) c = parent[c]; return c; };
+	int before = after;
+	for (std::pair<int, int> edge : joined) {
+		int a = root(component[edge.first]), b = root(component[edge.second]);
+		if (a == b) continue;
+		parent[a] = b;
+		before--;
+	}
+	if (sizesAfter) *sizesAfter = sizes;
+	if (sizesBefore) {
+		std::vector<int> total(after, 0);
+		for (int c = 0; c < after; c++) total[root(c)] += sizes[c];
+		sizesBefore->clear();
+		for (int c = 0; c < after; c++) if (root(c) == c) sizesBefore->push_back(total[c]);
+	}
+	return after - before;
+}
+
+int RegionMap::label(Point pos) const
+{
+	if (pos.first < 0 || pos.first >= _width || pos.second < 0 || pos.second >= _height) return -1;
+	return _labels[pos.first * _height + pos.second];
+}
+
+int RegionMap::find(int cell)
+{
+	while (_parent[cell] != cell) {
+		_parent[cell] = _parent[_parent[cell]];
+		cell = _parent[cell];
+	}
+	return cell;
+}
+
+bool RegionMap::isBlock(const std::vector<std::vector<int>>& grid, int width, int height, Point pos)
+{
+	return pos.first >= 0 && pos.first < width && pos.second >= 0 && pos.second < height && (grid[pos.first][pos.second] & Decoration::Empty) != Decoration::Empty;
+}
+
+//Edges on the border of the panel (except the sides of a pillar, which wrap around) and edges with the path or an opening on them separate regions
+bool RegionMap::crossable(const std::vector<std::vector<int>>& grid, int width, int height, int pillarWidth, Point edge)
+{
+	if (pillarWidth == 0 && (edge.first == 0 || edge.first + 1 == width) || edge.second == 0 || edge.second + 1 == height) return false;
+	return grid[edge.first][edge.second] != PATH && grid[edge.first][edge.second] != OPEN;
+}
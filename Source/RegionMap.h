@@ -0,0 +1,59 @@
+#pragma once
+#include "Panel.h"
+#include <vector>
+#include <set>
+#include <map>
+
+//The regions of a panel (grid blocks connected without crossing the path or an open edge), labeled in one union-find pass over the grid.
+//Looking up the region of a block is then a label comparison or a reference to its member list, instead of a flood fill per query.
+//Symbols placed on grid blocks don't change the regions, so a map stays valid while they are placed - it has to be built again once the path
+//or the edges change.
+class RegionMap
+{
+public:
+	//pillarWidth - as in Panel::_pillarWidth, the blocks on the two sides of a pillar are joined if it isn't 0
+	void build(const std::vector<std::vector<int>>& grid, int width, int height, int pillarWidth);
+
+	//Members of the region containing pos, sorted the same way as a std::set<Point>
+	const std::vector<Point>& region(Point pos);
+	bool same(Point pos1, Point pos2);
+	int numRegions() const { return static_cast<int>(_regions.size()); }
+	const std::vector<Point>& members(int index) const { return _regions[index]; }
+
+	//Symbols in a region by color (the low 4 bits of a symbol), so that the placement checks don't have to go over the region's members
+	struct ColorCounts {
+		int symbols[16] = {}; //Any non-zero value
+		int stars[16] = {};
+		int stones[16] = {};
+		int numStones = 0;
+	};
+	//Counts the symbols of every region, to be kept up to date with update from then on (Generate calls it on every set) until the next build
+	void countSymbols();
+	void update(Point pos, int oldValue, int newValue);
+	//nullptr if the symbols aren't counted or pos isn't labeled
+	const ColorCounts* counts(Point pos) const;
+
+	//Flood fill from pos, as used before the map was built (and for points the map doesn't label - edges and empty blocks)
+	static std::set<Point> Flood(const std::vector<std::vector<int>>& grid, int width, int height, int pillarWidth, Point pos);
+
+	//How many regions were added by laying the path on the given edges (already set in the grid), which could all be crossed before.
+	//Only the regions next to those edges are searched, so this can be called as each segment of a path is laid.
+	//sizesBefore/sizesAfter - if given, the sizes of those regions before the path was laid and after
+	static int Splits(const std::vector<std::vector<int>>& grid, int width, int height, int pillarWidth, const std::vector<Point>& edges,
+		std::vector<int>* sizesBefore = nullptr, std::vector<int>* sizesAfter = nullptr);
+
+private:
+	int label(Point pos) const;
+	static void count(ColorCounts& counts, int value, int amount);
+	int find(int cell);
+	static bool crossable(const std::vector<std::vector<int>>& grid, int width, int height, int pillarWidth, Point edge);
+	static bool isBlock(const std::vector<std::vector<int>>& grid, int width, int height, Point pos);
+
+	const std::vector<std::vector<int>>* _grid = nullptr;
+	int _width = 0, _height = 0, _pillarWidth = 0;
+	std::vector<int> _parent; //Union-find forest over the cells, indexed x * height + y
+	std::vector<int> _labels; //Region of each cell, -1 if it isn't a labeled block
+	std::vector<std::vector<Point>> _regions;
+	std::vector<ColorCounts> _counts; //Per region, empty until countSymbols
+	std::map<Point, std::vector<Point>> _unlabeled; //Regions found by flood fill for points without a label, kept until the next build
+};
@@ -0,0 +1,485 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Solver.h"
+#include "Polyomino.h"
+#include <algorithm>
+#include <cmath>
+
+static const Point Directions[] = { Point(0, 1), Point(0, -1), Point(1, 0), Point(-1, 0) };
+static const Point ArrowDirections[] = { Point(0, 2), Point(0, -2), Point(2, 0), Point(-2, 0), Point(2, 2), Point(2, -2), Point(-2, -2), Point(-2, 2) }; //Same order as Generate::_8DIRECTIONS2
+
+Solver::Solver(std::shared_ptr<Panel> panel)
+{
+	std::set<Point> starts(panel->_startpoints.begin(), panel->_startpoints.end()), exits;
+	for (Endpoint e : panel->_endpoints) exits.insert(Point(e.GetX(), e.GetY()));
+	*this = Solver(panel, starts, exits);
+}
+
+Solver::Solver(std::shared_ptr<Panel> panel, const std::set<Point>& starts, const std::set<Point>& exits)
+{
+	_panel = panel;
+	_width = panel->_width;
+	_height = panel->_height;
+	_pillarWidth = panel->_pillarWidth;
+	_symmetric = panel->symmetry != Panel::Symmetry::None;
+	_grid = panel->_grid;
+	_hasErasers = false;
+	_steps = _limit = _found = 0;
+	_hash = 0;
+	for (int x = 0; x < _width; x++) {
+		for (int y = 0; y < _height; y++) {
+			int& cell = _grid[x][y];
+			if (cell == PATH) cell = 0;
+			if (x % 2 == 1 && y % 2 == 1) {
+				if ((cell & 0x700) == Decoration::Eraser && (cell & Decoration::Empty) != Decoration::Empty) _hasErasers = true;
+				continue;
+			}
+			if (cell == OPEN || (x % 2 == 0 && y % 2 == 0 ? (cell & NO_POINT) : (cell & GAP))) _blocked.insert(Point(x, y));
+			else if (cell & DOT) {
+				_dots.insert(Point(x, y));
+				if (_symmetric && (cell & DOT_IS_BLUE)) _dots1.insert(Point(x, y));
+				if (_symmetric && (cell & DOT_IS_ORANGE)) _dots2.insert(Point(x, y));
+			}
+		}
+	}
+	_regionGrid = _grid;
+	for (Point p : starts) _starts.insert(p);
+	for (Point p : exits) _exits.insert(p);
+	//The line closes off a region when it reaches the edge of the panel, or an opening that splits up the regions
+	for (int x = 0; x < _width; x += 2) {
+		for (int y = 0; y < _height; y += 2) {
+			bool edge = (y == 0 || y == _height - 1 || _pillarWidth == 0 && (x == 0 || x == _width - 1));
+			for (Point dir : Directions) {
+				Point p = wrap(Point(x, y) + dir);
+				if (in_range(p) && _grid[p.first][p.second] == OPEN) edge = true;
+			}
+			if (edge) _edges.insert(Point(x, y));
+		}
+	}
+}
+
+Solver::Result Solver::solve(int maxSteps)
+{
+	int found = count(1, maxSteps);
+	return found > 0 ? Solved : found == 0 ? Unsolvable : Unknown;
+}
+
+int Solver::count(int limit, int maxSteps)
+{
+	_steps = maxSteps;
+	_limit = limit;
+	_found = 0;
+	_stats = Stats();
+	_solution.clear();
+	_memo.clear();
+	for (Point start : _starts) {
+		if (!in_range(start) || _blocked.count(start) || _symmetric && (sym(start) == start || _blocked.count(sym(start)))) continue;
+		if (_symmetric && limit > 1 && sym(start) < start && _starts.count(sym(start))) continue; //Found starting from the other line
+		occupy(start);
+		_trail = { start };
+		bool done = search(start, Point(0, 0));
+		release(start);
+		if (done) break;
+	}
+	if (_found < limit && _steps <= 0) return -1;
+	return _found;
+}
+
+//Continue the line from pos, which it reached going in direction dir ((0, 0) for a start). Returns true once the search is over
+bool Solver::search(Point pos, Point dir)
+{
+	if (_steps-- <= 0) return true;
+	if (_limit == 1) return extend(pos, dir);
+	uint64_t key = _hash ^ hash_point(pos, 1 + (dir.first + 1) * 3 + dir.second + 1);
+	auto it = _memo.find(key);
+	if (it != _memo.end()) {
+		_found += it->second;
+		return _found >= _limit;
+	}
+	int found = _found;
+	if (extend(pos, dir)) return true;
+	if (_memo.size() < 1 << 20) _memo[key] = _found - found;
+	return false;
+}
+
+bool Solver::extend(Point pos, Point dir)
+{
+	if (_trail.size() > 1 && _exits.count(pos) && (!_symmetric || _exits.count(sym(pos))) && check_solution()) {
+		if (_steps <= 0) return true; //The regions weren't checked all the way
+		if (_solution.size() == 0) {
+			_solution = _trail;
+			if (_symmetric) for (Point p : _trail) _solution.push_back(sym(p));
+		}
+		if (++_found >= _limit) return true;
+	}
+	bool vertex = (pos.first % 2 == 0 && pos.second % 2 == 0);
+	if (vertex && (_edges.count(pos) || _symmetric && _edges.count(sym(pos))) && !check_closed()) return false;
+	Point moves[4];
+	int numMoves = 0;
+	for (Point d : Directions) {
+		//On a segment the line has to keep going the same way (or either way along it, if it starts there)
+		if (!vertex) {
+			if (dir != Point(0, 0) && d != dir) continue;
+			if (pos.first % 2 == 1 ? d.first == 0 : d.second == 0) continue;
+		}
+		Point next = wrap(pos + d);
+		if (!in_range(next) || _blocked.count(next) || _used.count(next)) continue;
+		if (_symmetric) {
+			Point sp = sym(next);
+			if (sp == next || !in_range(sp) || _blocked.count(sp) || _used.count(sp)) continue;
+		}
+		moves[numMoves++] = d;
+	}
+	if (vertex) {
+		_stats.nodes++;
+		_stats.branches += numMoves;
+		if (numMoves == 1) _stats.forced++;
+	}
+	for (int i = 0; i < numMoves; i++) {
+		Point d = moves[i], next = wrap(pos + d);
+		occupy(next);
+		_trail.push_back(next);
+		bool done = search(next, d);
+		_trail.pop_back();
+		release(next);
+		if (done) return true;
+	}
+	return false;
+}
+
+void Solver::occupy(Point pos)
+{
+	_used.insert(pos);
+	_line1.insert(pos);
+	_hash ^= hash_point(pos, 0);
+	_regionGrid[pos.first][pos.second] = PATH;
+	if (_symmetric) {
+		Point sp = sym(pos);
+		_used.insert(sp);
+		_line2.insert(sp);
+		_regionGrid[sp.first][sp.second] = PATH;
+	}
+}
+
+void Solver::release(Point pos)
+{
+	_used.erase(pos);
+	_line1.erase(pos);
+	_hash ^= hash_point(pos, 0);
+	_regionGrid[pos.first][pos.second] = _grid[pos.first][pos.second];
+	if (_symmetric) {
+		Point sp = sym(pos);
+		_used.erase(sp);
+		_line2.erase(sp);
+		_regionGrid[sp.first][sp.second] = _grid[sp.first][sp.second];
+	}
+}
+
+//Check what can't change anymore with the line where it is now: an exit has to be in reach, as well as every dot (unless erasers could take care of
+//them), and the regions the line can't get into have to be solved
+bool Solver::check_closed()
+{
+	Bitboard reachable;
+	std::vector<Point> check;
+	Point head = _trail.back();
+	std::vector<Point> heads = { head };
+	if (_symmetric) heads.push_back(sym(head));
+	for (Point h : heads) {
+		for (Point dir : Directions) {
+			Point p = wrap(h + dir);
+			if (in_range(p) && !_blocked.count(p) && !_used.count(p) && reachable.insert(p)) check.push_back(p);
+		}
+	}
+	while (check.size() > 0) {
+		Point pos = check.back();
+		check.pop_back();
+		for (Point dir : Directions) {
+			Point p = wrap(pos + dir);
+			if (in_range(p) && !_blocked.count(p) && !_used.count(p) && reachable.insert(p)) check.push_back(p);
+		}
+	}
+	Bitboard exits = _exits;
+	exits &= reachable;
+	if (exits.empty()) return false;
+	if (!_hasErasers) {
+		for (Point p : _dots) if (!_used.count(p) && !reachable.count(p)) return false;
+	}
+	_regions.build(_regionGrid, _width, _height, _pillarWidth);
+	for (int i = 0; i < _regions.numRegions(); i++) {
+		const std::vector<Point>& region = _regions.members(i);
+		bool closed = true;
+		for (Point p : region) {
+			for (int dx = -1; dx <= 1 && closed; dx++) {
+				for (int dy = -1; dy <= 1; dy++) {
+					if (reachable.count(wrap(Point(p.first + dx, p.second + dy)))) {
+						closed = false;
+						break;
+					}
+				}
+			}
+			if (!closed) break;
+		}
+		if (closed && !check_region(region, false)) return false;
+	}
+	return true;
+}
+
+//Check the whole panel once the line is at an exit
+bool Solver::check_solution()
+{
+	if (_symmetric) {
+		bool keep = true, swap = true; //Either line may be the blue one
+		for (Point p : _dots1) {
+			if (!_line1.count(p)) keep = false;
+			if (!_line2.count(p)) swap = false;
+		}
+		for (Point p : _dots2) {
+			if (!_line2.count(p)) keep = false;
+			if (!_line1.count(p)) swap = false;
+		}
+		if (!keep && !swap) return false;
+	}
+	if (!_hasErasers) {
+		for (Point p : _dots) if (!_used.count(p)) return false;
+	}
+	_regions.build(_regionGrid, _width, _height, _pillarWidth);
+	for (int i = 0; i < _regions.numRegions(); i++) {
+		if (!check_region(_regions.members(i), true)) return false;
+	}
+	return true;
+}
+
+//Check the symbols in a region. Arrows depend on the line outside the region, so regions with arrows are only checked when final is set
+bool Solver::check_region(const std::vector<Point>& region, bool final)
+{
+	std::vector<Symbol> symbols, erasers;
+	Bitboard missedDots;
+	for (Point p : region) {
+		int value = _grid[p.first][p.second];
+		if (value != 0 && (value & Decoration::Empty) != Decoration::Empty) {
+			if ((value & 0x700) == Decoration::Arrow && !final) return true;
+			if ((value & 0x700) == Decoration::Eraser) erasers.push_back({ p, value });
+			else symbols.push_back({ p, value });
+		}
+		if (!_hasErasers) continue;
+		for (int dx = -1; dx <= 1; dx++) {
+			for (int dy = -1; dy <= 1; dy++) {
+				Point q = wrap(Point(p.first + dx, p.second + dy));
+				if (_dots.count(q) && !_used.count(q) && missedDots.insert(q)) symbols.push_back({ q, 0 });
+			}
+		}
+	}
+	if (erasers.size() > 0) return check_erasers(region, symbols, erasers);
+	return check_symbols(region, symbols);
+}
+
+//The next larger mask with as many bits set (Gosper's hack), or 1 << n once there are none left
+static int next_subset(int mask, int n)
+{
+	if (mask == 0) return 1 << n;
+	int low = mask & -mask, ripple = mask + low;
+	return (((ripple ^ mask) >> 2) / low) | ripple;
+}
+
+//Each eraser has to take away exactly one other symbol (possibly another eraser, which then doesn't take anything away itself), and only symbols
+//that would be wrong otherwise. Every combination tried counts as a step, and running out of steps passes the region
+bool Solver::check_erasers(const std::vector<Point>& region, const std::vector<Symbol>& symbols, const std::vector<Symbol>& erasers)
+{
+	int n = static_cast<int>(symbols.size()), e = static_cast<int>(erasers.size());
+	if (n > 24 || e > 8) return true; //Far more than the generator makes, and too many combinations to go through
+	for (int erased = 0; erased * 2 <= e; erased++) {
+		int amount = e - erased * 2; //Symbols taken away by the erasers that aren't erased themselves
+		if (amount > n) continue;
+		for (int eraserMask = (1 << erased) - 1; eraserMask < (1 << e); eraserMask = next_subset(eraserMask, e)) {
+			for (int mask = (1 << amount) - 1; mask < (1 << n); mask = next_subset(mask, n)) {
+				if (_steps-- <= 0) return true;
+				std::vector<Symbol> remaining;
+				bool missedDot = false;
+				for (int i = 0; i < n; i++) {
+					if (mask & 1 << i) continue;
+					if (symbols[i].value == 0) missedDot = true;
+					remaining.push_back(symbols[i]);
+				}
+				if (missedDot) continue;
+				for (int i = 0; i < e; i++) if (!(eraserMask & 1 << i)) remaining.push_back(erasers[i]);
+				if (!check_symbols(region, remaining)) continue;
+				bool needed = true;
+				for (int i = 0; i < n && needed; i++) {
+					if (!(mask & 1 << i) || symbols[i].value == 0) continue;
+					remaining.push_back(symbols[i]);
+					if (check_symbols(region, remaining)) needed = false;
+					remaining.pop_back();
+				}
+				if (needed) return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool Solver::check_symbols(const std::vector<Point>& region, const std::vector<Symbol>& symbols)
+{
+	int stoneColor = -1;
+	std::vector<int> positive, negative, starColors;
+	for (const Symbol& s : symbols) {
+		int type = s.value & 0x700, color = s.value & 0xf;
+		if (s.value == 0) return false; //A dot the line missed
+		if (type == Decoration::Stone) {
+			if (stoneColor != -1 && stoneColor != color) return false;
+			stoneColor = color;
+		}
+		else if (type == Decoration::Star) starColors.push_back(color);
+		else if (type == Decoration::Triangle) {
+			if (count_sides(s.pos) != (s.value >> 16 & 0xf)) return false;
+		}
+		else if (type == Decoration::Arrow) {
+			if (count_crossings(s.pos, s.value >> 16 & 0xf) != (s.value >> 12 & 0xf)) return false;
+		}
+		else if (type == Decoration::Poly) {
+			if (s.value & Decoration::Negative) negative.push_back(s.value);
+			else positive.push_back(s.value);
+		}
+	}
+	for (int color : starColors) {
+		int count = 0;
+		for (const Symbol& s : symbols) if ((s.value & 0xf) == color) count++;
+		if (count != 2) return false;
+	}
+	return positive.size() == 0 || check_shapes(region, positive, negative);
+}
+
+//Whether the shapes fit the region exactly, the negative shapes taking away from the positive ones (anywhere on the panel)
+bool Solver::check_shapes(const std::vector<Point>& region, const std::vector<int>& positive, const std::vector<int>& negative)
+{
+	int area = 0;
+	std::vector<std::vector<std::vector<Point>>> pieces; //Positive shapes, then negative shapes - for each, the blocks of every rotation it can be placed in
+	for (int i = 0; i < positive.size() + negative.size(); i++) {
+		int value = (i < positive.size() ? positive[i] : negative[i - positive.size()]);
+		const Polyomino::Entry& entry = Polyomino::Get(value >> 16);
+		area += (i < positive.size() ? entry.size : -entry.size);
+		std::vector<std::vector<Point>> rotations;
+		for (int r = 0; r < ((value & Decoration::Can_Rotate) ? 4 : 1); r++) {
+			std::vector<Point> blocks;
+			for (int bit = 0; bit < 16; bit++) {
+				if (entry.rotations[r] & 1 << bit) blocks.push_back(Point(bit % 4, -(bit / 4)));
+			}
+			std::sort(blocks.begin(), blocks.end()); //Put the block that has to go on the first open block in front
+			if (std::find(rotations.begin(), rotations.end(), blocks) == rotations.end()) rotations.push_back(blocks);
+		}
+		pieces.push_back(rotations);
+	}
+	if (area == 0) return true; //The negative shapes cancel out the positive ones
+	if (area != region.size()) return false;
+	std::vector<int> required((_width / 2) * (_height / 2), 0);
+	for (Point p : region) required[block_index(p.first / 2, p.second / 2)] = 1;
+	std::vector<bool> used(pieces.size(), false);
+	return place_negative(required, pieces, used, static_cast<int>(negative.size()), static_cast<int>(positive.size()));
+}
+
+bool Solver::place_negative(std::vector<int>& required, const std::vector<std::vector<std::vector<Point>>>& pieces, std::vector<bool>& used, int numNegative, int index)
+{
+	if (index == pieces.size()) return place_positive(required, pieces, used);
+	for (const std::vector<Point>& blocks : pieces[index]) {
+		for (int x = 0; x < _width / 2; x++) {
+			for (int y = 0; y < _height / 2; y++) {
+				if (_steps-- <= 0) return true;
+				std::vector<int> indices;
+				for (Point b : blocks) {
+					int i = block_index(x + b.first, y + b.second);
+					if (i == -1) break;
+					indices.push_back(i);
+				}
+				if (indices.size() < blocks.size()) continue;
+				for (int i : indices) required[i]++;
+				bool result = place_negative(required, pieces, used, numNegative, index + 1);
+				for (int i : indices) required[i]--;
+				if (result) return true;
+			}
+		}
+	}
+	return false;
+}
+
+//Cover the first block left to cover with one of the positive shapes that are left
+bool Solver::place_positive(std::vector<int>& required, const std::vector<std::vector<std::vector<Point>>>& pieces, std::vector<bool>& used)
+{
+	if (_steps-- <= 0) return true;
+	int first = -1;
+	Point target;
+	for (int x = 0; x < _width / 2 && first == -1; x++) {
+		for (int y = 0; y < _height / 2; y++) {
+			if (required[block_index(x, y)] > 0) {
+				first = block_index(x, y);
+				target = Point(x, y);
+				break;
+			}
+		}
+	}
+	if (first == -1) return true;
+	for (int i = 0; i < pieces.size(); i++) {
+		if (used[i] || pieces[i].size() == 0) continue;
+		for (const std::vector<Point>& blocks : pieces[i]) {
+			std::vector<int> indices;
+			for (Point b : blocks) {
+				int index = block_index(target.first + b.first - blocks[0].first, target.second + b.second - blocks[0].second);
+				if (index == -1 || required[index] == 0) break;
+				indices.push_back(index);
+			}
+			if (indices.size() < blocks.size()) continue;
+			for (int index : indices) required[index]--;
+			used[i] = true;
+			bool result = place_positive(required, pieces, used);
+			used[i] = false;
+			for (int index : indices) required[index]++;
+			if (result) return true;
+		}
+	}
+	return false;
+}
+
+int Solver::count_sides(Point pos)
+{
+	int count = 0;
+	for (Point dir : Directions) if (_used.count(wrap(pos + dir))) count++;
+	return count;
+}
+
+int Solver::count_crossings(Point pos, int direction)
+{
+	Point dir = ArrowDirections[direction & 7];
+	int count = 0;
+	pos = wrap(pos + dir / 2);
+	for (int steps = 0; in_range(pos) && steps < _width + _height; steps++) {
+		if (_used.count(pos)) count++;
+		pos = wrap(pos + dir);
+	}
+	return count;
+}
+
+//Index of the grid block in column x, row y (counted in blocks), or -1 if there is none
+int Solver::block_index(int x, int y)
+{
+	int columns = _width / 2, rows = _height / 2;
+	if (_pillarWidth) x = (x % columns + columns) % columns;
+	if (x < 0 || x >= columns || y < 0 || y >= rows) return -1;
+	return x * rows + y;
+}
+
+//Random looking bits for a cell (splitmix64 of its coordinates), so the cells of a line can be combined into a hash with xor
+uint64_t Solver::hash_point(Point pos, int salt)
+{
+	uint64_t z = (static_cast<uint64_t>(salt) << 32 | static_cast<uint64_t>(pos.first) << 16 | static_cast<uint64_t>(pos.second & 0xFFFF)) + 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+//Search spent on choices rather than on moves the line had to make, on a log scale - every step up is about twice as many places where the solver had
+//to pick a way to go, times the ways it had on average. Single path mazes and panels solved by following the dots come out low. Meant for the stats of explore
+double Solver::Stats::difficulty() const
+{
+	if (nodes == 0) return 0;
+	return log2(1.0 + (nodes - forced) * static_cast<double>(branches) / nodes);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "Panel.h"
+#include "Bitboard.h"
+#include "RegionMap.h"
+#include <climits>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+//Solver for the panels the generator makes - stones, stars, shapes (rotated and negative), erasers, triangles, arrows, dots, gaps and symmetry.
+//The line is run one cell at a time through the grid as the generator lays it out (intersections at even coordinates, the segments between them
+//at one odd coordinate), with the cells it covers kept as bitboards. Whenever the line reaches the edge of the panel, the regions it can't get
+//to anymore won't change, so they are checked right away rather than once the line reaches an exit.
+class Solver
+{
+public:
+	enum Result { Unsolvable, Solved, Unknown };
+
+	Solver(std::shared_ptr<Panel> panel); //Starts and exits are taken from the panel
+	Solver(std::shared_ptr<Panel> panel, const std::set<Point>& starts, const std::set<Point>& exits);
+
+	//Look for a solution. Gives up with Unknown after maxSteps moves of the line (shape fitting counts towards this too)
+	Result solve(int maxSteps = 1000000);
+	//Count the solutions, stopping at limit. Returns -1 if it runs out of steps first. With symmetry, the two lines swapped count as the same solution.
+	//Searches from a position reached before with the same line are looked up instead of repeated.
+	int count(int limit, int maxSteps = 1000000);
+	//Count every solution. The search then reaches each position once whichever way it tries first, so its stats don't depend on the order of the moves
+	//(those of solve and of a count that stops at its limit do). Returns -1 if it runs out of steps first
+	int explore(int maxSteps = 1000000) { return count(INT_MAX, maxSteps); }
+	//How the search for the last solve, count or explore went, counting only the intersections the line got to (segments never leave a choice)
+	struct Stats {
+		int nodes = 0; //Intersections reached
+		int forced = 0; //Of those, the ones with a single way to go on
+		int branches = 0; //Ways to go on, over all of them (branches / nodes is the average branching)
+		double difficulty() const;
+	};
+	const Stats& stats() const { return _stats; }
+	//Cells covered by the line in the solution found, in the order it covers them (with symmetry, followed by those of the other line)
+	const std::vector<Point>& solution() const { return _solution; }
+
+private:
+	struct Symbol {
+		Point pos;
+		int value; //As in the panel grid, 0 for a dot the line missed (only kept track of for the erasers)
+	};
+
+	bool search(Point pos, Point dir);
+	bool extend(Point pos, Point dir);
+	static uint64_t hash_point(Point pos, int salt);
+	void occupy(Point pos);
+	void release(Point pos);
+	bool check_closed();
+	bool check_solution();
+	bool check_region(const std::vector<Point>& region, bool final);
+	bool check_erasers(const std::vector<Point>& region, const std::vector<Symbol>& symbols, const std::vector<Symbol>& erasers);
+	bool check_symbols(const std::vector<Point>& region, const std::vector<Symbol>& symbols);
+	bool check_shapes(const std::vector<Point>& region, const std::vector<int>& positive, const std::vector<int>& negative);
+	bool place_negative(std::vector<int>& required, const std::vector<std::vector<std::vector<Point>>>& pieces, std::vector<bool>& used, int numNegative, int index);
+	bool place_positive(std::vector<int>& required, const std::vector<std::vector<std::vector<Point>>>& pieces, std::vector<bool>& used);
+	int count_sides(Point pos);
+	int count_crossings(Point pos, int direction);
+	bool in_range(Point pos) { return pos.second >= 0 && pos.second < _height && (_pillarWidth || pos.first >= 0 && pos.first < _width); }
+	Point wrap(Point pos) { return pos.wrap(_pillarWidth); }
+	int block_index(int x, int y);
+	Point sym(Point pos) { return _panel->get_sym_point(pos); }
+
+	std::shared_ptr<Panel> _panel;
+	int _width, _height, _pillarWidth;
+	bool _symmetric;
+	std::vector<std::vector<int>> _grid; //The panel grid without the generator's path
+	std::vector<std::vector<int>> _regionGrid; //_grid with the line laid on it, for labeling the regions
+	Bitboard _blocked; //Cells the line can't go through
+	Bitboard _starts, _exits, _edges; //_edges - intersections where the line can close off a region
+	Bitboard _dots, _dots1, _dots2; //_dots1/_dots2 - dots for one of the two lines (blue and yellow) with symmetry
+	Bitboard _line1, _line2, _used;
+	bool _hasErasers;
+	RegionMap _regions;
+	std::vector<Point> _trail;
+	std::vector<Point> _solution;
+	int _steps;
+	int _limit, _found;
+	Stats _stats;
+	uint64_t _hash; //Of the cells in _line1
+	std::unordered_map<uint64_t, int> _memo; //Solutions found from each position (and line) the search has finished
+};
@@ -54,13 +54,13 @@ void Special::generateReflectionDotPuzzle(std::shared_ptr<Generate> gen, int id1
 	}
 	if (split) {
 		int size = static_cast<int>(dots.size());
-		while (dots.size() > size / 2 + Random::rand() % 2) {
+		while (dots.size() > size / 2 + random->rand() % 2) {
 			Point dot = pop_random(dots);
 			Point sp = puzzle->get_sym_point(dot.first, dot.second, symmetry);
 			puzzle->_grid[dot.first][dot.second] |= IntersectionFlags::DOT_IS_INVISIBLE;
 			flippedPuzzle->_grid[sp.first][sp.second] &= ~IntersectionFlags::DOT_IS_INVISIBLE;
 		}
-		if (Random::rand() % 2) {
+		if (random->rand() % 2) {
 			Point dot = pop_random(dots);
 			Point sp = puzzle->get_sym_point(dot.first, dot.second, symmetry);
 			flippedPuzzle->_grid[sp.first][sp.second] &= ~IntersectionFlags::DOT_IS_INVISIBLE;
@@ -93,7 +93,7 @@ void Special::generateAntiPuzzle(int id)
 	while (true) {
 		generator->setFlagOnce(Generate::Config::DisableWrite);
 		generator->generate(id, Decoration::Poly | Decoration::Can_Rotate, 2);
-		std::set<Point> open = generator->_gridpos;
+		Bitboard open = generator->_gridpos;
 		std::vector<int> symbols;
 		for (int x = 1; x < generator->_panel->_width; x += 2) {
 			for (int y = 1; y < generator->_panel->_height; y += 2) {
@@ -146,7 +146,7 @@ void Special::generateColorFilterPuzzle(int id, Point size, const std::vector<st
 		}
 	}
 	for (int i = 0; i < availableColors.size(); i++) { //Shuffle
-		std::swap(availableColors[i], availableColors[Random::rand() % availableColors.size()]);
+		std::swap(availableColors[i], availableColors[random->rand() % availableColors.size()]);
 	}
 	std::vector<Color> symbolColors;
 	for (int y = generator->_panel->_height - 2; y>0; y -= 2) {
@@ -160,9 +160,9 @@ void Special::generateColorFilterPuzzle(int id, Point size, const std::vector<st
 		//Add random variation in remaining color channel(s)
 		for (Color &c : symbolColors) {
 			if (c.a == 0) continue;
-			if (filter.r == 0) c.r = static_cast<float>(Random::rand() % 2);
-			if (filter.g == 0) c.g = static_cast<float>(Random::rand() % 2);
-			if (filter.b == 0) c.b = static_cast<float>(Random::rand() % 2);
+			if (filter.r == 0) c.r = static_cast<float>(random->rand() % 2);
+			if (filter.g == 0) c.g = static_cast<float>(random->rand() % 2);
+			if (filter.b == 0) c.b = static_cast<float>(random->rand() % 2);
 		}
 		//Check for solvability
 		std::map<Color, int> colorCounts;
@@ -543,7 +543,7 @@ void Special::generateJungleVault(int id)
 	std::vector<std::vector<int>> dotPoints2 = { { 7, 8, 13 }, { 3, 5, 6, 10, 11, 15, 17, 18, 20, 21, 22 }, { 14, 1 } };
 	generator->initPanel(id);
 	generator->clear();
-	int sol = Random::rand() % sols.size();
+	int sol = random->rand() % sols.size();
 	auto[x1, y1] = generator->_panel->loc_to_xy(generator->pick_random(dotPoints1[sol]));
 	auto[x2, y2] = generator->_panel->loc_to_xy(generator->pick_random(dotPoints2[sol]));
 	generator->set(x1, y1, Decoration::Dot_Intersection);
@@ -634,17 +634,7 @@ void Special::generateKeepLaserPuzzle(int id, const std::set<Point>& path1, cons
 		for (Point p : pathPoints3) generator->set_path(p);
 	}
 
-	std::vector<std::string> solution; //For debugging only
-	for (int y = 0; y < generator->_panel->_height; y++) {
-		std::string row;
-		for (int x = 0; x < generator->_panel->_width; x++) {
-			if (generator->get(x, y) == PATH) {
-				row += "xx";
-			}
-			else row += "    ";
-		}
-		solution.push_back(row);
-	}
+	TRACE_PATH("generateKeepLaserPuzzle", id, generator->_panel->_width, generator->_panel->_height, [&](int x, int y) { return generator->get(x, y) == PATH; });
 
 	while (!generator->place_all_symbols(psymbols)) {
 		for (int x = 0; x < generator->_panel->_width; x++)
@@ -653,7 +643,7 @@ void Special::generateKeepLaserPuzzle(int id, const std::set<Point>& path1, cons
 					generator->set(x, y, 0);
 		generator->_openpos = generator->_gridpos;
 		for (int i = 0; i < psymbols.symbols[Decoration::Poly].size(); i++) {
-			psymbols.symbols[Decoration::Poly][i].second = psymbolsBackup.symbols[Decoration::Poly][i].second + Random::rand() % 3 - Random::rand() % 3;
+			psymbols.symbols[Decoration::Poly][i].second = psymbolsBackup.symbols[Decoration::Poly][i].second + random->rand() % 3 - random->rand() % 3;
 			if (psymbols.symbols[Decoration::Poly][i].second < 1) psymbols.symbols[Decoration::Poly][i].second = 1;
 		}
 	}
@@ -702,7 +692,7 @@ void Special::generateMountaintop(int id, const std::vector<std::pair<int, int>>
 	};
 
 	std::vector<std::shared_ptr<Generate>> gens;
-	for (int i = 0; i < 3; i++) gens.push_back(std::make_shared<Generate>());
+	for (int i = 0; i < 3; i++) gens.push_back(std::make_shared<Generate>(random));
 	for (std::shared_ptr<Generate> g : gens) {
 		g->setGridSize(5, 5);
 		g->setSymbol(Decoration::Gap, 5, 0);
@@ -724,7 +714,7 @@ void Special::generateMultiPuzzle(std::vector<int> ids, const std::vector<std::v
 	std::vector<PuzzleSymbols> symbols;
 	for (auto sym : symbolVec) symbols.emplace_back(PuzzleSymbols(sym));
 	std::vector<Generate> gens;
-	for (int i = 0; i < ids.size(); i++) gens.emplace_back(Generate());
+	for (int i = 0; i < ids.size(); i++) gens.emplace_back(Generate(random));
 	for (int i = 0; i < ids.size(); i++) {
 		gens[i].setFlag(Generate::Config::DisableWrite);
 		gens[i].setFlag(Generate::WriteColors);
@@ -764,24 +754,14 @@ bool Special::generateMultiPuzzle(std::vector<int> ids, std::vector<Generate>& g
 				return false;
 		}
 	}
-	std::vector<std::string> solution; //For debugging only
-	for (int y = 0; y < 11; y++) {
-		std::string row;
-		for (int x = 0; x < 11; x++) {
-			if (path.count(Point(x, y))) {
-				row += "xx";
-			}
-			else row += "    ";
-		}
-		solution.push_back(row);
-	}
+	TRACE_PATH("generateMultiPuzzle", ids[0], 11, 11, [&](int x, int y) { return path.count(Point(x, y)); });
 	return true;
 }
 
 void Special::generate2Bridge(int id1, int id2)
 {
 	std::vector<std::shared_ptr<Generate>> gens;
-	for (int i = 0; i < 3; i++) gens.push_back(std::make_shared<Generate>());
+	for (int i = 0; i < 3; i++) gens.push_back(std::make_shared<Generate>(random));
 	for (std::shared_ptr<Generate> g : gens) {
 		g->setFlag(Generate::Config::DisableWrite);
 		g->setFlag(Generate::Config::DisableReset);
@@ -862,7 +842,7 @@ bool Special::generate2Bridge(int id1, int id2, std::vector<std::shared_ptr<Gene
 void Special::generate2BridgeH(int id1, int id2)
 {
 	std::vector<std::shared_ptr<Generate>> gens;
-	for (int i = 0; i < 3; i++) gens.push_back(std::make_shared<Generate>());
+	for (int i = 0; i < 3; i++) gens.push_back(std::make_shared<Generate>(random));
 	for (std::shared_ptr<Generate> g : gens) {
 		g->setFlag(Generate::Config::DisableWrite);
 		g->setFlag(Generate::Config::DisableReset);
@@ -964,7 +944,7 @@ bool Special::generate2BridgeH(int id1, int id2, std::vector<std::shared_ptr<Gen
 	}
 
 	int count = 0;
-	std::set<Point> open = gens[0]->_gridpos;
+	Bitboard open = gens[0]->_gridpos;
 	while (open.size() > 0) {
 		Point pos = *(open.begin());
 		std::set<Point> region = gens[1]->get_region(pos);
@@ -1038,7 +1018,7 @@ void Special::generateMountainFloor()
 		for (Point p : floorPos) sym.insert(generator->get(p));
 	} while (sym.size() < 4);
 
-	int rotateIndex = Random::rand() % 3;
+	int rotateIndex = random->rand() % 3;
 	for (int i = 0; i < 4; i++) {
 		int symbol = generator->get(floorPos[i]);
 		//Convert to shape
@@ -1051,7 +1031,7 @@ void Special::generateMountainFloor()
 		//Translate randomly
 		Shape newShape;
 		do {
-			Point shift = Point((Random::rand() % 4) * 2, -(Random::rand() % 4) * 2);
+			Point shift = Point((random->rand() % 4) * 2, -(random->rand() % 4) * 2);
 			newShape.clear();
 			for (Point p : shape) newShape.insert(p + shift);
 		} while (!checkShape(newShape, i % 2));
@@ -1063,7 +1043,7 @@ void Special::generateMountainFloor()
 			}
 		}
 
-		Generate gen;
+		Generate gen(random);
 		for (Point p : newShape) {
 			for (Point dir : Generate::_DIRECTIONS2) {
 				if (!newShape.count(p + dir)) {
@@ -1139,12 +1119,12 @@ void Special::generateMountainFloorH()
 				generateMountainFloorH();
 				return;
 			}
-			Point shift = Point((Random::rand() % 4) * 2, -(Random::rand() % 4) * 2);
+			Point shift = Point((random->rand() % 4) * 2, -(random->rand() % 4) * 2);
 			newShape.clear();
 			for (Point p : shape) newShape.insert(p + shift);
 		} while (!checkShape(newShape, i % 2));
 
-		Generate gen;
+		Generate gen(random);
 		for (Point p : newShape) {
 			for (Point dir : Generate::_DIRECTIONS2) {
 				if (!newShape.count(p + dir)) {
@@ -1205,9 +1185,9 @@ void Special::generateMountainFloorH()
 void Special::generatePivotPanel(int id, Point gridSize, const std::vector<std::pair<int, int>>& symbolVec, bool colorblind) {
 	int width = gridSize.first * 2 + 1, height = gridSize.second * 2 + 1;
 	std::vector<std::shared_ptr<Generate>> gens;
-	for (int i = 0; i < 3; i++) gens.push_back(std::make_shared<Generate>());
+	for (int i = 0; i < 3; i++) gens.push_back(std::make_shared<Generate>(random));
 	for (std::shared_ptr<Generate> gen : gens) {
-		gen->seed(Random::rand());
+		gen->seed(random->rand());
 		gen->colorblind = colorblind;
 		gen->setSymbol(Decoration::Start, width / 2, height - 1);
 		gen->setGridSize(gridSize.first, gridSize.second);
@@ -1275,19 +1255,26 @@ void Special::modifyGate(int id)
 }
 
 void Special::addDecoyExits(std::shared_ptr<Generate> gen, int amount) {
-	while (amount > 0) {
+	int rejected = 0;
+	while (amount > 0 && rejected < 100) {
 		Point pos;
-		switch (Random::rand() % 4) {
-		case 0: pos = Point(0, Random::rand() % gen->_height); break;
-		case 1: pos = Point(gen->_width - 1, Random::rand() % gen->_height); break;
-		case 2: pos = Point(Random::rand() % gen->_width, 0); break;
-		case 3: pos = Point(Random::rand() % gen->_width, gen->_height - 1); break;
+		switch (random->rand() % 4) {
+		case 0: pos = Point(0, random->rand() % gen->_height); break;
+		case 1: pos = Point(gen->_width - 1, random->rand() % gen->_height); break;
+		case 2: pos = Point(random->rand() % gen->_width, 0); break;
+		case 3: pos = Point(random->rand() % gen->_width, gen->_height - 1); break;
 		}
 		if (pos.first % 2) pos.first--;
 		if (pos.second % 2) pos.second--;
 		if (gen->_exits.count(pos) || gen->_exits.count(gen->get_sym_point(pos)))
 			continue;
 		gen->_panel->SetGridSymbol(pos.first, pos.second, Decoration::Exit, Decoration::Color::None);
+		//A decoy mustn't be a way out of the maze
+		if (!gen->cut_off(pos)) {
+			gen->_panel->_endpoints.pop_back();
+			rejected++;
+			continue;
+		}
 		gen->_exits.insert(pos);
 		amount--;
 	}
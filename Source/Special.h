@@ -22,6 +22,7 @@ public:
 
 	Special(std::shared_ptr<Generate> generator) {
 		this->generator = generator;
+		this->random = generator->_random;
 	}
 	
 	void generateSpecialSymMaze(std::shared_ptr<Generate> gen, int id);
@@ -90,16 +91,24 @@ public:
 	static void setTargetAndDeactivate(int puzzle, int target)
 	{
 		std::shared_ptr<Memory> _memory = std::make_shared<Memory>("witness64_d3d11.exe");
-		if (!hasBeenRandomized()) //Only deactivate on a fresh save file (since power state is preserved)
+		WorldImage::RecordPanelData<float>(target, POWER, { 0.0, 0.0 }, WorldImage::FreshSaveOnly);
+		if (!hasBeenRandomized()) { //Only deactivate on a fresh save file (since power state is preserved)
+			WorldImage::Pause pause;
 			_memory->WritePanelData<float>(target, POWER, { 0.0, 0.0 });
+		}
 		WritePanelData(puzzle, TARGET, target + 1);
 	}
 	static void setPower(int puzzle, bool power) {
 
 		std::shared_ptr<Memory> _memory = std::make_shared<Memory>("witness64_d3d11.exe");
-		if (!power && hasBeenRandomized()) return; //Only deactivate on a fresh save file (since power state is preserved)
-		if (power) _memory->WritePanelData<float>(puzzle, POWER, { 1.0, 1.0 });
-		else _memory->WritePanelData<float>(puzzle, POWER, { 0.0, 0.0 });
+		if (power) {
+			_memory->WritePanelData<float>(puzzle, POWER, { 1.0, 1.0 });
+			return;
+		}
+		WorldImage::RecordPanelData<float>(puzzle, POWER, { 0.0, 0.0 }, WorldImage::FreshSaveOnly);
+		if (hasBeenRandomized()) return; //Only deactivate on a fresh save file (since power state is preserved)
+		WorldImage::Pause pause;
+		_memory->WritePanelData<float>(puzzle, POWER, { 0.0, 0.0 });
 	}
 	template <class T> static std::vector<T> ReadPanelData(int panel, int offset, size_t size) {
 		std::shared_ptr<Memory> _memory = std::make_shared<Memory>("witness64_d3d11.exe"); return _memory->ReadPanelData<T>(panel, offset, size);
@@ -200,18 +209,19 @@ public:
 private:
 
 	std::shared_ptr<Generate> generator;
+	std::shared_ptr<Random> random;
 
-	template <class T> T pick_random(std::vector<T>& vec) { return vec[Random::rand() % vec.size()]; }
-	template <class T> T pick_random(std::set<T>& set) { auto it = set.begin(); std::advance(it, Random::rand() % set.size()); return *it; }
+	template <class T> T pick_random(std::vector<T>& vec) { return vec[random->rand() % vec.size()]; }
+	template <class T> T pick_random(std::set<T>& set) { auto it = set.begin(); std::advance(it, random->rand() % set.size()); return *it; }
 	template <class T> T pop_random(std::vector<T>& vec) {
-		int i = Random::rand() % vec.size();
+		int i = random->rand() % vec.size();
 		T item = vec[i];
 		vec.erase(vec.begin() + i);
 		return item;
 	}
 	template <class T> T pop_random(std::set<T>& set) {
 		auto it = set.begin();
-		std::advance(it, Random::rand() % set.size());
+		std::advance(it, random->rand() % set.size());
 		T item = *it;
 		set.erase(item);
 		return item;
@@ -0,0 +1,74 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "Trace.h"
+#include <sstream>
+#include <iomanip>
+
+#if TRACE_LEVEL >= 1
+
+Trace::Slot Trace::_slots[Trace::Capacity];
+std::atomic<unsigned long long> Trace::_next(0);
+
+Trace::Event& Trace::Claim(unsigned long long& index) {
+	index = _next.fetch_add(1, std::memory_order_relaxed);
+	Slot& slot = _slots[index & (Capacity - 1)];
+	slot.sequence.store(0, std::memory_order_relaxed);
+	return slot.event;
+}
+
+void Trace::Publish(unsigned long long index) {
+	_slots[index & (Capacity - 1)].sequence.store(index + 1, std::memory_order_release);
+}
+
+void Trace::RecordWrite(const char* site, int panel, int x, int y, int value) {
+	unsigned long long index;
+	Event& event = Claim(index);
+	event.type = GridWrite;
+	event.site = site;
+	event.panel = panel;
+	event.x = x;
+	event.y = y;
+	event.value = value;
+	Publish(index);
+}
+
+//Events being overwritten while the dump is made are left out
+std::string Trace::Dump(int panel) {
+	std::stringstream ss;
+	unsigned long long next = _next.load(std::memory_order_acquire);
+	for (unsigned long long index = next > Capacity ? next - Capacity : 0; index < next; index++) {
+		const Slot& slot = _slots[index & (Capacity - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != index + 1) continue;
+		Event event = slot.event;
+		if (slot.sequence.load(std::memory_order_acquire) != index + 1) continue;
+		if (panel != 0 && event.panel != panel) continue;
+		ss << "#" << index << " 0x" << std::hex << std::setw(5) << std::setfill('0') << event.panel << std::dec << std::setfill(' ') << " " << event.site;
+		if (event.type == GridWrite) {
+			ss << ": (" << event.x << ", " << event.y << ") = 0x" << std::hex << event.value << std::dec << std::endl;
+			continue;
+		}
+		ss << ":" << std::endl;
+		for (int y = 0; y < event.height; y++) {
+			for (int x = 0; x < event.width; x++) ss << ((event.rows[y] >> x & 1) ? "xx" : "  ");
+			ss << std::endl;
+		}
+	}
+	return ss.str();
+}
+
+void Trace::Clear() {
+	for (Slot& slot : _slots) slot.sequence.store(0, std::memory_order_relaxed);
+	_next.store(0, std::memory_order_release);
+}
+
+#else
+
+std::string Trace::Dump(int panel) {
+	return "Tracing is off (TRACE_LEVEL 0)\n";
+}
+
+void Trace::Clear() { }
+
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <string>
+
+//Trace level, fixed at compile time: 0 - off, every TRACE_ macro compiles to nothing. 1 - snapshots of the solution path as it is generated.
+//2 - also every write to a generator's grid (symbols placed, path set, cells cleared). Define TRACE_LEVEL for the project to turn it on.
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL 0
+#endif
+
+//Events recorded while generating, for debugging the generators. Events go into a fixed size ring buffer (the oldest are overwritten) that any thread
+//can record into without locking, and are only turned into text when Dump is called, e.g. from the debugger's immediate window.
+class Trace
+{
+public:
+	enum EventType { PathSnapshot, GridWrite };
+
+	static const int MaxSize = 32; //Path snapshots only keep the first MaxSize rows and columns of a grid
+	static const int Capacity = 1 << 12; //Must be a power of two
+
+	struct Event {
+		int type;
+		const char* site; //Where the event was recorded (a string literal)
+		int panel;
+		int x, y, value; //GridWrite
+		int width, height; //PathSnapshot
+		unsigned int rows[MaxSize]; //PathSnapshot - bit x of rows[y] is set if (x, y) is on the path
+	};
+
+	//onPath(x, y) returns true if the point is on the path
+	template <class F> static void RecordPath(const char* site, int panel, int width, int height, F onPath) {
+		unsigned long long index;
+		Event& event = Claim(index);
+		event.type = PathSnapshot;
+		event.site = site;
+		event.panel = panel;
+		event.width = width < MaxSize ? width : MaxSize;
+		event.height = height < MaxSize ? height : MaxSize;
+		for (int y = 0; y < event.height; y++) {
+			event.rows[y] = 0;
+			for (int x = 0; x < event.width; x++) if (onPath(x, y)) event.rows[y] |= 1u << x;
+		}
+		Publish(index);
+	}
+	static void RecordWrite(const char* site, int panel, int x, int y, int value);
+
+	//The events still in the buffer, oldest first, as text (paths drawn in ASCII). panel - only the events of this panel, 0 for all of them
+	static std::string Dump(int panel = 0);
+	static void Clear();
+
+private:
+	struct Slot {
+		std::atomic<unsigned long long> sequence; //Index of the event + 1 once it has been written, 0 while it is being written
+		Event event;
+	};
+
+	static Event& Claim(unsigned long long& index);
+	static void Publish(unsigned long long index);
+
+	static Slot _slots[Capacity];
+	static std::atomic<unsigned long long> _next;
+};
+
+#if TRACE_LEVEL >= 1
+#define TRACE_PATH(site, panel, width, height, ...) Trace::RecordPath(site, panel, width, height, __VA_ARGS__)
+#else
+#define TRACE_PATH(site, panel, width, height, ...) ((void)0)
+#endif
+
+#if TRACE_LEVEL >= 2
+#define TRACE_WRITE(site, panel, x, y, value) Trace::RecordWrite(site, panel, x, y, value)
+#else
+#define TRACE_WRITE(site, panel, x, y, value) ((void)0)
+#endif
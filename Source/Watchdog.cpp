@@ -6,8 +6,27 @@
 #include "Quaternion.h"
 #include <thread>
 
+Watchdog* Watchdog::create(const std::vector<int>& data)
+{
+	if (data.size() == 0) return nullptr;
+	switch (data[0]) {
+	case Keep: return new KeepWatchdog();
+	case Arrow: if (data.size() >= 3) return new ArrowWatchdog(data[1], data[2]); break;
+	case Bridge: if (data.size() >= 3) return new BridgeWatchdog(data[1], data[2]); break;
+	case Treehouse: if (data.size() >= 2) return new TreehouseWatchdog(data[1]); break;
+	case Jungle:
+		if (data.size() >= 3 && data[2] >= 0 && data.size() >= 3 + static_cast<size_t>(data[2]))
+			return new JungleWatchdog(data[1], std::vector<int>(data.begin() + 3, data.begin() + 3 + data[2]), std::vector<int>(data.begin() + 3 + data[2], data.end()));
+		break;
+	case TownDoor: return new TownDoorWatchdog();
+	}
+	return nullptr;
+}
+
 void Watchdog::start()
 {
+	WorldImage::RecordWatchdog(imageData());
+	if (Memory::IsDryRun()) return; //Nothing has actually been written to the game
 	std::thread{ &Watchdog::run, this }.detach();
 }
 
@@ -160,7 +179,7 @@ bool ArrowWatchdog::checkArrowPillar(int x, int y)
 		return true;
 	int targetCount = (symbol & 0xf000) >> 12;
 	Point dir = DIRECTIONS[(symbol & 0xf0000) >> 16];
-	x = (x + (dir.first > 2 ? -2 : dir.first) / 2 + pillarWidth) % pillarWidth; y += dir.second / 2;
+	x = (x + dir.first / 2 + pillarWidth) % pillarWidth; y += dir.second / 2;
 	int count = 0;
 	while (y >= 0 && y < height) {
 		if (grid[x][y] == PATH) {
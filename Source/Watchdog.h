@@ -12,9 +12,12 @@ public:
 		sleepTime = time;
 		_memory = std::make_shared<Memory>("witness64_d3d11.exe");
 	};
+	enum Type { Keep, Arrow, Bridge, Treehouse, Jungle, TownDoor };
+	static Watchdog* create(const std::vector<int>& data);
 	void start();
 	void run();
 	virtual void action() = 0;
+	virtual std::vector<int> imageData() = 0; //Type and constructor arguments, so the watchdog can be started again from a world image
 	float sleepTime;
 	bool terminate;
 protected:
@@ -43,6 +46,7 @@ class KeepWatchdog : public Watchdog {
 public:
 	KeepWatchdog() : Watchdog(10) { }
 	virtual void action();
+	virtual std::vector<int> imageData() { return { Keep }; }
 };
 
 class ArrowWatchdog : public Watchdog {
@@ -66,6 +70,7 @@ public:
 		if (pillarWidth > 0) exitPoint = (width / 2) * (height / 2 + 1);
 	}
 	virtual void action();
+	virtual std::vector<int> imageData() { return { Arrow, id, pillarWidth }; }
 	void initPath();
 	bool checkArrow(int x, int y);
 	bool checkArrowPillar(int x, int y);
@@ -89,6 +94,7 @@ public:
 		this->id1 = id1; this->id2 = id2;
 	}
 	virtual void action();
+	virtual std::vector<int> imageData() { return { Bridge, id1, id2 }; }
 	bool checkTouch(int id);
 	int id1, id2, solLength1, solLength2;
 };
@@ -97,6 +103,7 @@ class TreehouseWatchdog : public Watchdog {
 public:
 	TreehouseWatchdog(int id) : Watchdog(1) { }
 	virtual void action();
+	virtual std::vector<int> imageData() { return { Treehouse, 0 }; }
 };
 
 class JungleWatchdog : public Watchdog {
@@ -113,6 +120,12 @@ public:
 		ptr2 = ReadPanelData<long>(id, DOT_SEQUENCE_REFLECTION);
 	}
 	virtual void action();
+	virtual std::vector<int> imageData() {
+		std::vector<int> data = { Jungle, id, static_cast<int>(correctSeq1.size()) };
+		data.insert(data.end(), correctSeq1.begin(), correctSeq1.end());
+		data.insert(data.end(), correctSeq2.begin(), correctSeq2.end());
+		return data;
+	}
 	int id;
 	std::vector<int> sizes;
 	long ptr1, ptr2;
@@ -125,4 +138,5 @@ class TownDoorWatchdog : public Watchdog {
 public:
 	TownDoorWatchdog() : Watchdog(0.2f) { }
 	virtual void action();
+	virtual std::vector<int> imageData() { return { TownDoor }; }
 };
\ No newline at end of file
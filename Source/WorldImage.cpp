@@ -0,0 +1,250 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+#include "WorldImage.h"
+#include "Memory.h"
+#include "Special.h"
+#include "Watchdog.h"
+#include <fstream>
+
+#define WORLD_IMAGE_MAGIC 0x49575257 //"WRWI"
+#define WORLD_IMAGE_FORMAT 7
+#define WORLD_CACHE_DIRECTORY "WRPGcache"
+
+thread_local std::shared_ptr<WorldImage> WorldImage::recording = nullptr;
+thread_local int WorldImage::paused = 0;
+
+//FNV-1a, used to detect truncated or corrupted image files
+static unsigned int checksum(const std::vector<unsigned char>& bytes, size_t size) {
+	unsigned int hash = 2166136261u;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static void putInt(std::vector<unsigned char>& bytes, int value) {
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(&value);
+	bytes.insert(bytes.end(), p, p + sizeof(int));
+}
+
+static bool getInt(const std::vector<unsigned char>& bytes, size_t& pos, int& value) {
+	if (pos + sizeof(int) > bytes.size()) return false;
+	memcpy(&value, &bytes[pos], sizeof(int));
+	pos += sizeof(int);
+	return true;
+}
+
+bool WorldImage::Save(const std::string& filename) const {
+	std::vector<unsigned char> bytes;
+	putInt(bytes, WORLD_IMAGE_MAGIC);
+	putInt(bytes, WORLD_IMAGE_FORMAT);
+	putInt(bytes, key.seed);
+	putInt(bytes, key.hard);
+	putInt(bytes, key.doubleMode);
+	putInt(bytes, key.colorblind);
+	putInt(bytes, key.randomSeed);
+	putInt(bytes, key.version);
+	putInt(bytes, static_cast<int>(key.sources));
+	putInt(bytes, key.streams);
+	putInt(bytes, key.verified);
+	putInt(bytes, static_cast<int>(ops.size()));
+	for (const Op& op : ops) {
+		putInt(bytes, op.type);
+		putInt(bytes, op.flags);
+		putInt(bytes, op.panel);
+		putInt(bytes, op.panel2);
+		putInt(bytes, op.offset);
+		putInt(bytes, static_cast<int>(op.data.size()));
+		bytes.insert(bytes.end(), op.data.begin(), op.data.end());
+		putInt(bytes, static_cast<int>(op.args.size()));
+		for (int arg : op.args) putInt(bytes, arg);
+	}
+	putInt(bytes, checksum(bytes, bytes.size()));
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file) return false;
+	file.write(reinterpret_cast<const char*>(&bytes[0]), bytes.size());
+	return file.good();
+}
+
+std::shared_ptr<WorldImage> WorldImage::Load(const std::string& filename) {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file) return nullptr;
+	std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (bytes.size() < sizeof(int) * 13) return nullptr;
+	int storedChecksum;
+	size_t end = bytes.size() - sizeof(int);
+	memcpy(&storedChecksum, &bytes[end], sizeof(int));
+	if (static_cast<unsigned int>(storedChecksum) != checksum(bytes, end)) return nullptr;
+	bytes.resize(end);
+
+	size_t pos = 0;
+	int magic, format, hard, doubleMode, colorblind, randomSeed, sources, verified, numOps;
+	Key key;
+	if (!getInt(bytes, pos, magic) || magic != WORLD_IMAGE_MAGIC) return nullptr;
+	if (!getInt(bytes, pos, format) || format != WORLD_IMAGE_FORMAT) return nullptr;
+	getInt(bytes, pos, key.seed);
+	getInt(bytes, pos, hard);
+	getInt(bytes, pos, doubleMode);
+	getInt(bytes, pos, colorblind);
+	getInt(bytes, pos, randomSeed);
+	getInt(bytes, pos, key.version);
+	getInt(bytes, pos, sources);
+	getInt(bytes, pos, key.streams);
+	getInt(bytes, pos, verified);
+	key.hard = hard; key.doubleMode = doubleMode; key.colorblind = colorblind; key.randomSeed = randomSeed; key.verified = verified;
+	key.sources = static_cast<unsigned int>(sources);
+	if (!getInt(bytes, pos, numOps) || numOps < 0) return nullptr;
+	std::shared_ptr<WorldImage> image = std::make_shared<WorldImage>(key);
+	image->ops.resize(numOps);
+	for (Op& op : image->ops) {
+		int dataSize, numArgs;
+		if (!getInt(bytes, pos, op.type) || !getInt(bytes, pos, op.flags) || !getInt(bytes, pos, op.panel) ||
+			!getInt(bytes, pos, op.panel2) || !getInt(bytes, pos, op.offset) || !getInt(bytes, pos, dataSize)) return nullptr;
+		if (dataSize < 0 || pos + dataSize > bytes.size()) return nullptr;
+		op.data.assign(bytes.begin() + pos, bytes.begin() + pos + dataSize);
+		pos += dataSize;
+		if (!getInt(bytes, pos, numArgs) || numArgs < 0) return nullptr;
+		op.args.resize(numArgs);
+		for (int& arg : op.args) if (!getInt(bytes, pos, arg)) return nullptr;
+	}
+	if (pos != bytes.size()) return nullptr;
+	return image;
+}
+
+//FNV-1a again, 64 bit so that a changed panel can't go unnoticed
+static void hashBytes(unsigned long long& hash, const unsigned char* bytes, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+
+static void hashInt(unsigned long long& hash, int value) {
+	hashBytes(hash, reinterpret_cast<const unsigned char*>(&value), sizeof(int));
+}
+
+std::map<int, unsigned long long> WorldImage::PanelHashes() const {
+	std::map<int, unsigned long long> hashes;
+	for (const Op& op : ops) {
+		std::vector<int> panels = { op.panel };
+		if (op.type == Swap) panels.push_back(op.panel2);
+		for (int panel : panels) {
+			unsigned long long& hash = hashes.emplace(panel, 14695981039346656037ull).first->second;
+			hashInt(hash, op.type);
+			hashInt(hash, op.flags);
+			hashInt(hash, op.type == Swap ? (panel == op.panel ? op.panel2 : op.panel) : op.panel2);
+			hashInt(hash, op.offset);
+			hashInt(hash, static_cast<int>(op.data.size()));
+			if (op.data.size() > 0) hashBytes(hash, &op.data[0], op.data.size());
+			for (int arg : op.args) hashInt(hash, arg);
+		}
+	}
+	return hashes;
+}
+
+std::string WorldImage::CachePath(const Key& key) {
+	std::stringstream ss;
+	ss << WORLD_CACHE_DIRECTORY << "/" << key.seed << (key.hard ? "_expert" : "_normal");
+	if (key.doubleMode) ss << "_double";
+	if (key.colorblind) ss << "_colorblind";
+	if (key.randomSeed) ss << "_random";
+	if (key.streams) ss << "_streams" << key.streams;
+	if (key.verified) ss << "_verified";
+	ss << ".wrpg";
+	return ss.str();
+}
+
+std::shared_ptr<WorldImage> WorldImage::LoadCached(const Key& key) {
+	std::string filename = CachePath(key);
+	std::shared_ptr<WorldImage> image = Load(filename);
+	if (image && image->key == key) return image;
+	if (image) std::remove(filename.c_str()); //Out of date
+	return nullptr;
+}
+
+bool WorldImage::SaveCached() const {
+	CreateDirectoryA(WORLD_CACHE_DIRECTORY, NULL);
+	return Save(CachePath(key));
+}
+
+void WorldImage::Apply(std::shared_ptr<Memory> memory) const {
+	const bool freshSave = !Special::hasBeenRandomized();
+	//Panel writes between two other ops are merged per panel (later writes overriding earlier ones), then sent as one write per contiguous range
+	std::map<int, std::map<int, unsigned char>> pending;
+	for (const Op& op : ops) {
+		if ((op.flags & FreshSaveOnly) && !freshSave) continue;
+		if (op.type == PanelData) {
+			std::map<int, unsigned char>& panelBytes = pending[op.panel];
+			for (size_t i = 0; i < op.data.size(); i++) panelBytes[op.offset + static_cast<int>(i)] = op.data[i];
+			continue;
+		}
+		//Everything else depends on the panel state so far
+		ApplyPanelData(memory, pending);
+		if (op.type == Array) {
+			memory->WriteArrayBytes(op.panel, op.offset, op.data, op.args.size() > 0 ? op.args[0] : 1, (op.flags & ForceArray) != 0);
+		}
+		else if (op.type == Swap) {
+			for (size_t i = 0; i + 1 < op.args.size(); i += 2) {
+				std::vector<unsigned char> panel1data = memory->ReadPanelData<unsigned char>(op.panel, op.args[i], op.args[i + 1]);
+				std::vector<unsigned char> panel2data = memory->ReadPanelData<unsigned char>(op.panel2, op.args[i], op.args[i + 1]);
+				memory->WritePanelData<unsigned char>(op.panel2, op.args[i], panel1data);
+				memory->WritePanelData<unsigned char>(op.panel, op.args[i], panel2data);
+			}
+		}
+		else if (op.type == StartWatchdog) {
+			Watchdog* watchdog = Watchdog::create(op.args);
+			if (watchdog) watchdog->start();
+		}
+	}
+	ApplyPanelData(memory, pending);
+}
+
+void WorldImage::ApplyPanelData(std::shared_ptr<Memory> memory, std::map<int, std::map<int, unsigned char>>& pending) const {
+	for (auto const&[panel, panelBytes] : pending) {
+		std::vector<unsigned char> run;
+		int start = 0;
+		for (auto const&[offset, value] : panelBytes) {
+			if (run.size() > 0 && offset != start + static_cast<int>(run.size())) {
+				memory->WritePanelData<unsigned char>(panel, start, run);
+				run.clear();
+			}
+			if (run.size() == 0) start = offset;
+			run.push_back(value);
+		}
+		if (run.size() > 0) memory->WritePanelData<unsigned char>(panel, start, run);
+	}
+	pending.clear();
+}
+
+void WorldImage::StartRecording(std::shared_ptr<WorldImage> image) {
+	recording = image;
+}
+
+std::shared_ptr<WorldImage> WorldImage::StopRecording() {
+	std::shared_ptr<WorldImage> image = recording;
+	recording = nullptr;
+	return image;
+}
+
+void WorldImage::RecordSwap(int panel1, int panel2, const std::map<int, int>& offsets) {
+	if (!IsRecording()) return;
+	std::vector<int> args;
+	for (auto const&[offset, size] : offsets) {
+		args.push_back(offset);
+		args.push_back(size);
+	}
+	recording->ops.push_back({ Swap, 0, panel1, panel2, 0, {}, args });
+}
+
+void WorldImage::RecordWatchdog(const std::vector<int>& args) {
+	if (!IsRecording()) return;
+	recording->ops.push_back({ StartWatchdog, 0, 0, 0, 0, {}, args });
+}
+
+void WorldImage::RecordImage(const WorldImage& image) {
+	if (!IsRecording()) return;
+	recording->ops.insert(recording->ops.end(), image.ops.begin(), image.ops.end());
+}
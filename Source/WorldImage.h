@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <cstring>
+#include "GeneratorHash.h" //Written before each build by GeneratorHash.ps1
+
+class Memory;
+
+//World images are keyed on GENERATOR_SOURCE_HASH, a hash of the generator sources (see GeneratorHash.ps1), so a change to the generators or to PuzzleList
+//keeps old world images from being reused without anything to remember. Increase this for a change elsewhere that alters what is written for a given
+//seed. Whether a change alters the puzzles can be checked with -golden (see Randomizer::CheckGoldenHashes)
+#define GENERATOR_VERSION 15
+
+//A world image is the complete result of randomizing with a given seed: every write made into the game while generating, in order.
+//It is recorded while the generators run (see Memory::WritePanelData/WriteArray) and can be saved to disk and applied again later without regenerating.
+class WorldImage
+{
+public:
+	struct Key {
+		int seed = 0;
+		bool hard = false;
+		bool doubleMode = false;
+		bool colorblind = false;
+		bool randomSeed = false; //Changes what is drawn on the seed panel
+		int version = GENERATOR_VERSION;
+		unsigned int sources = GENERATOR_SOURCE_HASH;
+		int streams = 0; //Random::Mode the world was generated with
+		bool verified = false; //Every panel was checked with the Solver while generating
+		bool operator==(const Key& other) const {
+			return seed == other.seed && hard == other.hard && doubleMode == other.doubleMode && colorblind == other.colorblind &&
+				randomSeed == other.randomSeed && version == other.version && sources == other.sources && streams == other.streams && verified == other.verified;
+		}
+		bool operator!=(const Key& other) const { return !(*this == other); }
+	};
+
+	enum OpType {
+		PanelData, //Bytes written directly into the panel struct
+		Array, //Contents of an array pointed to by the panel struct (reallocated in the game when applied if it doesn't fit). args - { element size }
+		Swap, //Exchange of panel fields between two panels (pointers included, so it can't be stored as plain bytes)
+		StartWatchdog, //A watchdog thread to start once the panels are in place
+	};
+
+	enum OpFlags {
+		FreshSaveOnly = 0x1, //Only applied if the save file hasn't been randomized before (power states are preserved in the save)
+		ForceArray = 0x2, //Array is always reallocated
+	};
+
+	struct Op {
+		int type;
+		int flags;
+		int panel;
+		int panel2;
+		int offset;
+		std::vector<unsigned char> data;
+		std::vector<int> args;
+	};
+
+	WorldImage(const Key& key) { this->key = key; }
+
+	Key key;
+	std::vector<Op> ops;
+
+	bool Save(const std::string& filename) const;
+	static std::shared_ptr<WorldImage> Load(const std::string& filename);
+	void Apply(std::shared_ptr<Memory> memory) const;
+
+	//A hash of every op made on each panel, in order (swaps count for both panels, watchdogs for panel 0). Used to check that a seed still produces
+	//the same puzzles (see Randomizer::CheckGoldenHashes)
+	std::map<int, unsigned long long> PanelHashes() const;
+
+	//World cache - a directory of previously generated worlds, one file per key (version excluded).
+	//Entries generated by a different version are deleted when found.
+	static std::string CachePath(const Key& key);
+	static std::shared_ptr<WorldImage> LoadCached(const Key& key);
+	bool SaveCached() const;
+
+	//Recording - only writes made on the thread that started the recording are captured, so running watchdogs don't end up in the image.
+	//Worker threads record into images of their own, which are added to the main recording with RecordImage.
+	static void StartRecording(std::shared_ptr<WorldImage> image);
+	static std::shared_ptr<WorldImage> StopRecording();
+	static bool IsRecording() { return recording != nullptr && paused == 0; }
+
+	template <class T> static void RecordPanelData(int panel, int offset, const std::vector<T>& data, int flags = 0) {
+		if (!IsRecording() || data.size() == 0) return;
+		recording->ops.push_back({ PanelData, flags, panel, 0, offset, ToBytes(data), {} });
+	}
+	template <class T> static void RecordArray(int panel, int offset, const std::vector<T>& data, bool force) {
+		if (!IsRecording() || data.size() == 0) return;
+		recording->ops.push_back({ Array, force ? ForceArray : 0, panel, 0, offset, ToBytes(data), { static_cast<int>(sizeof(T)) } });
+	}
+	static void RecordSwap(int panel1, int panel2, const std::map<int, int>& offsets);
+	static void RecordWatchdog(const std::vector<int>& args);
+	static void RecordImage(const WorldImage& image);
+
+	//Writes made while a Pause is in scope are not recorded (used when a higher level operation has already been recorded)
+	struct Pause {
+		Pause() { paused++; }
+		~Pause() { paused--; }
+	};
+
+private:
+	template <class T> static std::vector<unsigned char> ToBytes(const std::vector<T>& data) {
+		std::vector<unsigned char> bytes(sizeof(T) * data.size());
+		memcpy(&bytes[0], &data[0], bytes.size());
+		return bytes;
+	}
+
+	void ApplyPanelData(std::shared_ptr<Memory> memory, std::map<int, std::map<int, unsigned char>>& pending) const;
+
+	static thread_local std::shared_ptr<WorldImage> recording;
+	static thread_local int paused;
+};
@@ -0,0 +1,212 @@
+#pragma once
+//Stand-in for the game for the drivers in this folder - made up panels (normal grids and pillars) in this process's own memory, with the WinAPI
+//functions Memory uses defined on top of them (see Tests/stubs), plus the generator calls run on each panel. It only uses what the generators
+//have always had, so it can be built against older versions of them too.
+
+#include "Generate.h"
+#include "Memory.h"
+#include <psapi.h>
+#include <tlhelp32.h>
+#include <functional>
+
+static const char* ProcessName = "witness64_d3d11.exe";
+static uintptr_t fakeModule[1]; //Base address of the game - its first word points at the globals
+static uintptr_t fakeGlobals[8]; //The panel table is at offset 0x18
+static uintptr_t panelTable[0x40000];
+
+//Everything the generators read from the game is put in here, as heap addresses could fall in the range of the dry run's arrays (see Memory.cpp)
+static unsigned char arena[0x100000];
+static size_t arenaUsed = 0;
+//Arrays allocated by the generators, if writing is allowed
+static unsigned char allocations[0x100000];
+static size_t allocationsUsed = 0;
+//Without it, anything that writes to the game throws - generators that should only be writing to a dry run can't change what the others read
+static bool fakeGameWritable = false;
+
+template <class T> static T* Place(const std::vector<T>& data) {
+	T* ptr = reinterpret_cast<T*>(&arena[arenaUsed]);
+	memcpy(ptr, &data[0], sizeof(T) * data.size());
+	arenaUsed += (sizeof(T) * data.size() + 15) & ~static_cast<size_t>(15);
+	return ptr;
+}
+
+struct FakePanel {
+	std::vector<unsigned char> data = std::vector<unsigned char>(0x1000);
+	std::vector<float> positions;
+	std::vector<int> flags, connectionsA, connectionsB, decorations;
+	template <class T> void set(int offset, T value) { memcpy(&data[offset], &value, sizeof(T)); }
+};
+
+//A panel of columns x rows intersections, starting in the bottom left corner and exiting up from the top right one (top left on a pillar)
+static void AddPanel(int id, int columns, int rows, bool pillar) {
+	FakePanel panel;
+	int width = pillar ? columns * 2 : columns * 2 - 1, height = rows * 2 - 1;
+	auto loc = [&](int c, int r) { return r * columns + c; }; //r counts from the bottom
+	for (int r = 0; r < rows; r++) {
+		for (int c = 0; c < columns; c++) {
+			panel.positions.push_back(pillar ? 2.0f * c / width : static_cast<float>(c) / (columns - 1));
+			panel.positions.push_back(static_cast<float>(r) / (rows - 1));
+			panel.flags.push_back(IntersectionFlags::INTERSECTION | (c == 0 && r == 0 ? IntersectionFlags::STARTPOINT : 0));
+			if (r > 0) { panel.connectionsA.push_back(loc(c, r - 1)); panel.connectionsB.push_back(loc(c, r)); }
+			if (c > 0) { panel.connectionsA.push_back(loc(c - 1, r)); panel.connectionsB.push_back(loc(c, r)); }
+		}
+		if (pillar) { panel.connectionsA.push_back(loc(columns - 1, r)); panel.connectionsB.push_back(loc(0, r)); }
+	}
+	int exit = pillar ? loc(0, rows - 1) : loc(columns - 1, rows - 1);
+	panel.positions.push_back(panel.positions[exit * 2]);
+	panel.positions.push_back(panel.positions[exit * 2 + 1] + 0.05f);
+	panel.flags.push_back(IntersectionFlags::ENDPOINT);
+	panel.connectionsA.push_back(exit);
+	panel.connectionsB.push_back(static_cast<int>(panel.flags.size()) - 1);
+	panel.decorations.resize((width / 2) * (height / 2));
+	panel.set<int>(GRID_SIZE_X, columns);
+	panel.set<int>(GRID_SIZE_Y, rows);
+	panel.set<int>(IS_CYLINDER, pillar);
+	panel.set<int>(NUM_DOTS, static_cast<int>(panel.flags.size()));
+	panel.set<int>(NUM_CONNECTIONS, static_cast<int>(panel.connectionsA.size()));
+	panel.set<int>(NUM_DECORATIONS, static_cast<int>(panel.decorations.size()));
+	panel.set<float*>(DOT_POSITIONS, Place(panel.positions));
+	panel.set<int*>(DOT_FLAGS, Place(panel.flags));
+	panel.set<int*>(DOT_CONNECTION_A, Place(panel.connectionsA));
+	panel.set<int*>(DOT_CONNECTION_B, Place(panel.connectionsB));
+	panel.set<int*>(DECORATIONS, Place(panel.decorations));
+	panel.set<int*>(DECORATION_FLAGS, Place(panel.decorations));
+	panelTable[id] = reinterpret_cast<uintptr_t>(Place(panel.data));
+}
+
+//Puts every panel back the way it started. 0x100-0x105 are 5x5 grids, 0x200-0x20E 6 column pillars, and every other panel reads as zeros
+static void ResetFakeGame() {
+	arenaUsed = 0;
+	memset(allocations, 0, allocationsUsed);
+	allocationsUsed = 0;
+	fakeModule[0] = reinterpret_cast<uintptr_t>(fakeGlobals);
+	fakeGlobals[3] = reinterpret_cast<uintptr_t>(panelTable);
+	uintptr_t blank = reinterpret_cast<uintptr_t>(Place(std::vector<unsigned char>(0x1000)));
+	for (uintptr_t& panel : panelTable) panel = blank;
+	for (int id = 0x100; id <= 0x105; id++) AddPanel(id, 5, 5, false);
+	for (int id = 0x200; id <= 0x20E; id++) AddPanel(id, 6, 6, true);
+}
+
+//FNV-1a, as in WorldImage::PanelHashes
+static void HashBytes(unsigned long long& hash, const void* bytes, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		hash ^= static_cast<const unsigned char*>(bytes)[i];
+		hash *= 1099511628211ull;
+	}
+}
+
+//Hash of a panel as the game would draw it - its fields, with the arrays the generators write hashed by what is in them rather than where they
+//were put. Doesn't depend on how the panel was written (directly, or through a dry run and a world image), so any version can be compared with any other
+static unsigned long long PanelStateHash(int id) {
+	std::vector<unsigned char> data(reinterpret_cast<unsigned char*>(panelTable[id]), reinterpret_cast<unsigned char*>(panelTable[id]) + 0x1000);
+	auto count = [&](int offset) { int value; memcpy(&value, &data[offset], sizeof(int)); return value; };
+	int numDots = count(NUM_DOTS), numConnections = count(NUM_CONNECTIONS), numDecorations = count(NUM_DECORATIONS);
+	const std::vector<std::pair<int, int>> arrays = { //Offset, size in bytes
+		{ DOT_POSITIONS, numDots * 8 }, { DOT_FLAGS, numDots * 4 }, { REFLECTION_DATA, numDots * 4 },
+		{ DOT_CONNECTION_A, numConnections * 4 }, { DOT_CONNECTION_B, numConnections * 4 },
+		{ DECORATIONS, numDecorations * 4 }, { DECORATION_FLAGS, numDecorations * 4 }, { DECORATION_COLORS, numDecorations * 16 },
+		{ COLORED_REGIONS, count(NUM_COLORED_REGIONS) * 16 },
+	};
+	unsigned long long hash = 14695981039346656037ull;
+	for (const auto& [offset, size] : arrays) {
+		unsigned char* ptr;
+		memcpy(&ptr, &data[offset], sizeof(ptr));
+		memset(&data[offset], 0, sizeof(ptr));
+		int length = ptr ? size : -1;
+		HashBytes(hash, &length, sizeof(int));
+		if (ptr && size > 0) HashBytes(hash, ptr, size);
+	}
+	HashBytes(hash, &data[0], data.size());
+	return hash;
+}
+
+BOOL ReadProcessMemory(HANDLE, LPCVOID address, LPVOID buffer, SIZE_T size, SIZE_T* read) {
+	memcpy(buffer, address, size);
+	if (read) *read = size;
+	return TRUE;
+}
+BOOL WriteProcessMemory(HANDLE, LPVOID address, LPCVOID buffer, SIZE_T size, SIZE_T* written) {
+	if (!fakeGameWritable) throw std::exception("Only dry runs can write");
+	memcpy(address, buffer, size);
+	if (written) *written = size;
+	return TRUE;
+}
+LPVOID VirtualAllocEx(HANDLE, LPVOID, SIZE_T size, DWORD, DWORD) {
+	if (!fakeGameWritable) throw std::exception("Only dry runs can allocate");
+	if (allocationsUsed + size > sizeof(allocations)) throw std::exception("Out of room for arrays in the fake game");
+	LPVOID ptr = &allocations[allocationsUsed];
+	allocationsUsed += (size + 15) & ~static_cast<size_t>(15);
+	return ptr;
+}
+HANDLE CreateToolhelp32Snapshot(DWORD, DWORD) { return fakeModule; }
+BOOL Process32Next(HANDLE, PROCESSENTRY32* entry) { strcpy(entry->szExeFile, ProcessName); entry->th32ProcessID = 1; return TRUE; }
+HANDLE OpenProcess(DWORD, BOOL, DWORD) { return fakeModule; }
+BOOL EnumProcessModulesEx(HANDLE, HMODULE* modules, DWORD, DWORD* size, DWORD) { modules[0] = fakeModule; *size = sizeof(HMODULE); return TRUE; }
+DWORD GetModuleBaseNameA(HANDLE, HMODULE, char* name, DWORD size) { strncpy(name, ProcessName, size); return static_cast<DWORD>(strlen(ProcessName)); }
+BOOL CloseHandle(HANDLE) { return TRUE; }
+BOOL GetExitCodeProcess(HANDLE, DWORD* code) { *code = STILL_ACTIVE; return TRUE; }
+DWORD GetLastError() { return 0; }
+DWORD FormatMessageA(DWORD, LPCVOID, DWORD, DWORD, char*, DWORD, void*) { return 0; }
+DWORD GetTickCount() { return 0; }
+BOOL CreateDirectoryA(const char*, void*) { return TRUE; }
+BOOL CreateDirectory(LPCWSTR, void*) { return TRUE; }
+int MessageBox(HWND, LPCWSTR, LPCWSTR, UINT) { return 0; }
+int MessageBoxA(HWND, const char*, const char*, UINT) { return 0; }
+HWND GetActiveWindow() { return nullptr; }
+BOOL SetWindowText(HWND, LPCWSTR) { return TRUE; }
+int GetWindowText(HWND, LPWSTR, int) { return 0; }
+
+//Cases ----------------------------------------------------------------------------------------------
+
+struct Case {
+	int id;
+	std::function<void(Generate&)> run;
+};
+
+//The pillars are set to the sizes of the pillars in the caves
+static const std::vector<Case> cases = {
+	{ 0x100, [](Generate& gen) { gen.generate(0x100, Decoration::Stone | Decoration::Color::Black, 3, Decoration::Stone | Decoration::Color::White, 3); } },
+	{ 0x101, [](Generate& gen) { gen.generate(0x101, Decoration::Poly, 3, Decoration::Star | Decoration::Color::Orange, 2, Decoration::Dot, 3); } },
+	{ 0x102, [](Generate& gen) { gen.generate(0x102, Decoration::Triangle | Decoration::Color::Orange, 5, Decoration::Eraser | Decoration::Color::White, 1); } },
+	{ 0x103, [](Generate& gen) { gen.setSymmetry(Panel::Symmetry::Rotational);
+		gen.setSymbol(Decoration::Start, 0, 8); gen.setSymbol(Decoration::Start, 8, 0); gen.setSymbol(Decoration::Exit, 0, 0); gen.setSymbol(Decoration::Exit, 8, 8);
+		gen.generate(0x103, Decoration::Dot, 6, Decoration::Gap, 4); } },
+	{ 0x104, [](Generate& gen) { gen.generate(0x104, Decoration::Arrow | Decoration::Color::Black, 3, Decoration::Gap, 3); } },
+	{ 0x105, [](Generate& gen) { gen.generateMaze(0x105); } },
+	{ 0x200, [](Generate& gen) { gen.setGridSize(6, 3); gen.generate(0x200, Decoration::Dot, 15, Decoration::Gap, 6); } },
+	{ 0x201, [](Generate& gen) { gen.setGridSize(6, 3); gen.generate(0x201, Decoration::Star | Decoration::Color::Orange, 6, Decoration::Star | Decoration::Color::Magenta, 4); } },
+	{ 0x202, [](Generate& gen) { gen.setGridSize(6, 3); gen.generate(0x202, Decoration::Stone | Decoration::Color::Black, 4, Decoration::Stone | Decoration::Color::White, 4); } },
+	{ 0x203, [](Generate& gen) { gen.setGridSize(6, 3); gen.setFlag(Generate::Config::RequireCombineShapes); gen.generate(0x203, Decoration::Poly, 3); } },
+	{ 0x204, [](Generate& gen) { gen.setGridSize(6, 3); gen.setSymbol(Decoration::Start, 4, 6); gen.generate(0x204, Decoration::Dot_Intersection, 30, Decoration::Gap, 10); } },
+	{ 0x205, [](Generate& gen) { gen.setGridSize(6, 3); gen.setSymmetry(Panel::Symmetry::PillarRotational);
+		gen.setSymbol(Decoration::Start, 0, 6); gen.setSymbol(Decoration::Exit, 6, 6); gen.setSymbol(Decoration::Exit, 0, 0); gen.setSymbol(Decoration::Start, 6, 0);
+		gen.generate(0x205, Decoration::Star | Decoration::Color::Orange, 4, Decoration::Stone | Decoration::Color::Black, 2, Decoration::Stone | Decoration::Color::White, 2); } },
+	{ 0x206, [](Generate& gen) { gen.setGridSize(6, 3); gen.setSymmetry(Panel::Symmetry::PillarParallel); gen.setFlag(Generate::Config::DisableDotIntersection);
+		gen.setSymbol(Decoration::Start, 0, 6); gen.setSymbol(Decoration::Start, 6, 6); gen.setSymbol(Decoration::Exit, 0, 0); gen.setSymbol(Decoration::Exit, 6, 0);
+		gen.generate(0x206, Decoration::Dot, 8); } },
+	{ 0x207, [](Generate& gen) { gen.setGridSize(6, 4); gen.generate(0x207, Decoration::Star | Decoration::Color::Black, 2, Decoration::Star | Decoration::Color::White, 3,
+		Decoration::Stone | Decoration::Color::Black, 2, Decoration::Stone | Decoration::Color::White, 2); } },
+	{ 0x208, [](Generate& gen) { gen.setGridSize(6, 4); gen.generate(0x208, Decoration::Star | Decoration::Color::Orange, 4, Decoration::Star | Decoration::Color::Magenta, 4,
+		Decoration::Star | Decoration::Color::Green, 4, Decoration::Star | Decoration::Color::White, 1, Decoration::Triangle | Decoration::Color::White, 1, Decoration::Eraser | Decoration::Color::White, 1); } },
+	{ 0x209, [](Generate& gen) { gen.setGridSize(6, 5); gen.setSymmetry(Panel::Symmetry::PillarParallel);
+		gen.setSymbol(Decoration::Start, 0, 10); gen.setSymbol(Decoration::Start, 6, 10); gen.setSymbol(Decoration::Exit, 0, 0); gen.setSymbol(Decoration::Exit, 6, 0);
+		gen.generate(0x209, Decoration::Triangle | Decoration::Color::Orange, 8); } },
+	{ 0x20A, [](Generate& gen) { gen.setGridSize(6, 5); gen.setSymmetry(Panel::Symmetry::PillarHorizontal);
+		gen.setSymbol(Decoration::Start, 0, 10); gen.setSymbol(Decoration::Exit, 6, 10); gen.setSymbol(Decoration::Exit, 0, 0); gen.setSymbol(Decoration::Start, 6, 0);
+		gen.generate(0x20A, Decoration::Triangle | Decoration::Color::Orange, 4, Decoration::Dot_Intersection, 45); } },
+	{ 0x20B, [](Generate& gen) { gen.setGridSize(6, 4); gen.setFlag(Generate::Config::RequireCombineShapes); gen.setSymmetry(Panel::Symmetry::PillarRotational);
+		gen.setSymbol(Decoration::Start, 0, 8); gen.setSymbol(Decoration::Exit, 6, 8); gen.setSymbol(Decoration::Exit, 0, 0); gen.setSymbol(Decoration::Start, 6, 0);
+		gen.generate(0x20B, Decoration::Poly, 3, Decoration::Stone | Decoration::Color::Black, 2, Decoration::Stone | Decoration::Color::White, 2); } },
+	{ 0x20C, [](Generate& gen) { gen.setGridSize(6, 5); gen.setFlag(Generate::Config::RequireCancelShapes); gen.setFlag(Generate::Config::DisableDotIntersection);
+		gen.setSymmetry(Panel::Symmetry::PillarVertical);
+		gen.setSymbol(Decoration::Start, 2, 10); gen.setSymbol(Decoration::Start, 4, 10); gen.setSymbol(Decoration::Exit, 2, 0); gen.setSymbol(Decoration::Exit, 4, 0);
+		gen.generate(0x20C, Decoration::Poly | Decoration::Color::Orange, 1, Decoration::Poly | Decoration::Negative | Decoration::Color::Blue, 2,
+		Decoration::Poly | Decoration::Color::Blue, 1, Decoration::Poly | Decoration::Negative | Decoration::Color::Orange, 2,
+		Decoration::Star | Decoration::Color::Orange, 1, Decoration::Star | Decoration::Color::Blue, 1, Decoration::Dot, 4, Decoration::Start, 3); } },
+	{ 0x20D, [](Generate& gen) { gen.setGridSize(6, 5); gen.setSymmetry(Panel::Symmetry::PillarParallel);
+		gen.setSymbol(Decoration::Start, 0, 10); gen.setSymbol(Decoration::Start, 6, 10); gen.setSymbol(Decoration::Exit, 0, 0); gen.setSymbol(Decoration::Exit, 6, 0);
+		gen.generate(0x20D, Decoration::Triangle | Decoration::Color::Orange, 2, Decoration::Triangle | Decoration::Color::Magenta, 1,
+		Decoration::Star | Decoration::Color::Orange, 1, Decoration::Star | Decoration::Color::Magenta, 1, Decoration::Poly | Decoration::Color::Orange, 1,
+		Decoration::Poly | Decoration::Negative | Decoration::Color::Magenta, 2, Decoration::Eraser | Decoration::Color::Magenta, 1); } },
+	{ 0x20E, [](Generate& gen) { gen.setGridSize(6, 4); gen.generate(0x20E, Decoration::Arrow | Decoration::Color::Black, 3, Decoration::Gap, 2); } },
+};
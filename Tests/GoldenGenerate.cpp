@@ -0,0 +1,145 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+//Regression check for the puzzles produced for a seed, as with -golden in the app (see Randomizer::CheckGoldenHashes), but on the made up panels in
+//FakeGame.h so that it runs without the game on every build. Every case is generated for each seed listed in the golden hash file, with the streams of
+//earlier versions (Random::Sequential), and the panel it leaves behind is hashed (see PanelStateHash). Each one is generated twice - written to the game
+//directly, and recorded in a dry run then applied from the world image - and both have to match the hash in the file. Built like ParallelGenerate:
+//	g++ -std=c++17 -O2 -include windows.h -ITests/stubs -ISource Tests/GoldenGenerate.cpp Source/*.cpp -o GoldenGenerate -lpthread
+//	./GoldenGenerate Tests/GoldenHashes.txt [-record]
+//Lists every panel that diverged and exits with 1 if one did. With -record, the file is rewritten with the current hashes instead.
+
+#include "FakeGame.h"
+#include "WorldImage.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+struct GoldenSeed {
+	int seed;
+	std::map<int, unsigned long long> hashes;
+};
+
+//Hash of the panel the case leaves behind, starting from a fresh game. With imageApplied, the generator writes to a dry run and what it recorded is
+//applied to the game afterwards, as for a world from the cache
+static unsigned long long RunCase(const Case& c, int seed, bool imageApplied) {
+	ResetFakeGame();
+	fakeGameWritable = true;
+	std::shared_ptr<Generate> gen = std::make_shared<Generate>(std::make_shared<Random>(seed, Random::Sequential));
+	if (!imageApplied) c.run(*gen);
+	else {
+		Memory::StartDryRun();
+		WorldImage::StartRecording(std::make_shared<WorldImage>(WorldImage::Key()));
+		c.run(*gen);
+		std::shared_ptr<WorldImage> image = WorldImage::StopRecording();
+		Memory::StopDryRun();
+		image->Apply(std::make_shared<Memory>(ProcessName));
+	}
+	fakeGameWritable = false;
+	Panel::ClearGeneratedPanels();
+	return PanelStateHash(c.id);
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		printf("Usage: %s <golden hash file> [-record]\n", argv[0]);
+		return 1;
+	}
+	std::string filename = argv[1];
+	bool record = argc > 2 && std::string(argv[2]) == "-record";
+
+	//Same layout as the app's golden hash files, with "seed <seed>" in place of the worlds
+	std::vector<std::string> comments;
+	std::vector<GoldenSeed> seeds;
+	std::ifstream in(filename);
+	if (!in) {
+		printf("Couldn't read %s.\n", filename.c_str());
+		return 1;
+	}
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.size() > 0 && line.back() == '\r') line.pop_back();
+		std::stringstream ss(line);
+		std::string word;
+		if (!(ss >> word) || word[0] == '#') {
+			if (seeds.size() == 0) comments.push_back(line);
+			continue;
+		}
+		if (word == "seed") {
+			GoldenSeed seed;
+			if (!(ss >> seed.seed)) {
+				printf("Bad seed in %s: %s\n", filename.c_str(), line.c_str());
+				return 1;
+			}
+			seeds.push_back(seed);
+			continue;
+		}
+		unsigned long long hash;
+		if (seeds.size() == 0 || !(ss >> std::hex >> hash)) {
+			printf("Bad line in %s: %s\n", filename.c_str(), line.c_str());
+			return 1;
+		}
+		seeds.back().hashes[std::stoi(word, nullptr, 16)] = hash;
+	}
+	in.close();
+	if (seeds.size() == 0) {
+		printf("No seeds listed in %s.\n", filename.c_str());
+		return 1;
+	}
+	if (!record && std::all_of(seeds.begin(), seeds.end(), [](const GoldenSeed& seed) { return seed.hashes.size() == 0; })) {
+		printf("No golden hashes have been recorded in %s yet. Record them from a known good build with -record.\n", filename.c_str());
+		return 1;
+	}
+
+	int failed = 0;
+	for (GoldenSeed& seed : seeds) {
+		for (const Case& c : cases) {
+			unsigned long long direct, applied;
+			try {
+				direct = RunCase(c, seed.seed, false);
+				applied = RunCase(c, seed.seed, true);
+			}
+			catch (const std::exception& e) {
+				printf("seed %d: panel 0x%05X couldn't be generated: %s\n", seed.seed, c.id, e.what());
+				failed++;
+				continue;
+			}
+			if (applied != direct) {
+				printf("seed %d: panel 0x%05X comes out as %016llx when applied from its world image, %016llx when written directly\n", seed.seed, c.id, applied, direct);
+				failed++;
+			}
+			if (record) {
+				seed.hashes[c.id] = direct;
+				continue;
+			}
+			auto search = seed.hashes.find(c.id);
+			if (search == seed.hashes.end()) {
+				printf("seed %d: panel 0x%05X has no golden hash\n", seed.seed, c.id);
+				failed++;
+			}
+			else if (search->second != direct) {
+				printf("seed %d: panel 0x%05X is %016llx, %016llx in the golden hashes\n", seed.seed, c.id, direct, search->second);
+				failed++;
+			}
+		}
+	}
+
+	if (record) {
+		std::ofstream out(filename, std::ofstream::trunc);
+		for (const std::string& comment : comments) out << comment << std::endl;
+		for (const GoldenSeed& seed : seeds) {
+			out << "seed " << seed.seed << std::endl;
+			for (const std::pair<const int, unsigned long long>& entry : seed.hashes) {
+				out << "0x" << std::hex << std::setw(5) << std::setfill('0') << entry.first << " " << std::setw(16) << entry.second << std::dec << std::setfill(' ') << std::endl;
+			}
+		}
+		if (!out.good()) {
+			printf("Couldn't write %s.\n", filename.c_str());
+			return 1;
+		}
+	}
+	printf("%zu seeds of %zu panels %s, %d different\n", seeds.size(), cases.size(), record ? "recorded" : "checked", failed);
+	return failed > 0 ? 1 : 0;
+}
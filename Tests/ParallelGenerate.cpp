@@ -0,0 +1,73 @@
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+
+//Runs the generators on the made up panels in FakeGame.h without the game, to check that generators on different threads don't change
+//each other's puzzles. Every case is generated for each seed on one thread first, then again by 16 threads at once, each job on a dry run of its own,
+//and the hashes of the recorded panels have to come out the same. Built on Linux against the stubs in Tests/stubs, with the thread sanitizer:
+//	g++ -std=c++17 -g -O1 -fsanitize=thread -include windows.h -ITests/stubs -ISource Tests/ParallelGenerate.cpp Source/*.cpp -o ParallelGenerate -lpthread
+//	./ParallelGenerate [seeds] [threads]
+//Exits with 1 if a panel differs.
+
+#include "FakeGame.h"
+#include "WorldImage.h"
+#include <cstdio>
+
+//Sequential - the streams of earlier versions. Counter - per-panel streams, one attempt at a time. Verified - also checked by the Solver.
+//Parallel - several attempts at once (see Generate::retry), so that the generators start threads of their own as well
+enum Run { Sequential, Counter, Verified, Parallel };
+static const char* RunNames[] = { "Sequential", "Counter", "Verified", "Parallel" };
+
+struct Job {
+	const Case* c;
+	Run run;
+	int seed;
+};
+
+//Hash of the panel the case generates, as recorded into a world image. Each job gets a dry run of its own, as the generators read back what
+//was written before them (a panel generated twice on the same overlay doesn't start from the same state)
+static unsigned long long RunJob(const Job& job) {
+	Memory::StartDryRun();
+	WorldImage::StartRecording(std::make_shared<WorldImage>(WorldImage::Key()));
+	std::shared_ptr<Generate> gen = std::make_shared<Generate>(std::make_shared<Random>(job.seed, job.run == Sequential ? Random::Sequential : Random::Counter));
+	gen->setVerify(job.run == Verified);
+	gen->setParallelAttempts(job.run == Parallel ? 4 : 1);
+	job.c->run(*gen);
+	unsigned long long hash = WorldImage::StopRecording()->PanelHashes()[job.c->id];
+	Memory::StopDryRun();
+	return hash;
+}
+
+int main(int argc, char** argv) {
+	int seeds = argc > 1 ? atoi(argv[1]) : 4;
+	int numThreads = argc > 2 ? atoi(argv[2]) : 16;
+	ResetFakeGame();
+
+	//Each job is a different panel from the one before it, so that the threads work on grids and pillars at the same time
+	std::vector<Job> jobs;
+	for (int seed = 1; seed <= seeds; seed++) {
+		for (Run run : { Sequential, Counter, Verified, Parallel }) {
+			for (const Case& c : cases) jobs.push_back({ &c, run, seed });
+		}
+	}
+	std::vector<unsigned long long> expected;
+	for (const Job& job : jobs) expected.push_back(RunJob(job));
+
+	std::atomic<int> next = 0, failed = 0;
+	std::mutex printLock;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < numThreads; t++) {
+		threads.emplace_back([&]() {
+			for (int i = next++; i < jobs.size(); i = next++) {
+				unsigned long long hash = RunJob(jobs[i]);
+				if (hash == expected[i]) continue;
+				failed++;
+				std::lock_guard<std::mutex> lock(printLock);
+				printf("Panel 0x%03X (%s, seed %d) differs on its own thread: %016llx, %016llx on the first\n", jobs[i].c->id, RunNames[jobs[i].run], jobs[i].seed, hash, expected[i]);
+			}
+		});
+	}
+	for (std::thread& thread : threads) thread.join();
+	printf("%zu panels on %d threads, %d different\n", jobs.size(), numThreads, failed.load());
+	return failed > 0 ? 1 : 0;
+}
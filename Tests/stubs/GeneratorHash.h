@@ -0,0 +1,3 @@
+#pragma once
+//Stands in for the header GeneratorHash.ps1 writes into Source before each build
+#define GENERATOR_SOURCE_HASH 0u
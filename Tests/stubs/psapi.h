@@ -0,0 +1,4 @@
+#pragma once
+#include <windows.h>
+BOOL EnumProcessModulesEx(HANDLE, HMODULE*, DWORD, DWORD*, DWORD);
+DWORD GetModuleBaseNameA(HANDLE, HMODULE, char*, DWORD);
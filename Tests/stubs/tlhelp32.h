@@ -0,0 +1,6 @@
+#pragma once
+#include <windows.h>
+struct PROCESSENTRY32 { DWORD dwSize; DWORD th32ProcessID; char szExeFile[260]; };
+#define TH32CS_SNAPPROCESS 2
+HANDLE CreateToolhelp32Snapshot(DWORD, DWORD);
+BOOL Process32Next(HANDLE, PROCESSENTRY32*);
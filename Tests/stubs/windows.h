@@ -0,0 +1,152 @@
+#pragma once
+//Just enough of the Windows headers for the generator sources to build with g++ or clang, so that ParallelGenerate.cpp can run them on Linux
+//(and with -fsanitize=thread). The functions that touch the game are defined by the driver, the window functions do nothing.
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <climits>
+#include <cmath>
+#include <ctime>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+typedef void* HWND;
+typedef void* HANDLE;
+typedef void* HMODULE;
+typedef void* HINSTANCE;
+typedef void* HFONT;
+typedef void* HMENU;
+typedef void* HBRUSH;
+typedef void* HDC;
+typedef const void* LPCVOID;
+typedef void* LPVOID;
+typedef size_t SIZE_T;
+typedef unsigned long DWORD;
+typedef int BOOL;
+typedef long LONG;
+typedef unsigned int UINT;
+typedef unsigned char byte;
+typedef unsigned char BYTE;
+typedef wchar_t WCHAR;
+typedef wchar_t TCHAR;
+typedef const wchar_t* LPCWSTR;
+typedef wchar_t* LPWSTR;
+typedef intptr_t LPARAM;
+typedef uintptr_t WPARAM;
+typedef intptr_t LRESULT;
+
+#define CALLBACK
+#define WINAPI
+#define APIENTRY
+#define _In_
+#define _In_opt_
+#define TEXT(x) L##x
+#define FALSE 0
+#define TRUE 1
+#define INFINITE 0xFFFFFFFF
+#define MEM_COMMIT 1
+#define MEM_RESERVE 2
+#define PAGE_READWRITE 4
+#define MB_OK 0
+#define MB_OKCANCEL 1
+#define MB_YESNO 4
+#define IDOK 1
+#define IDYES 6
+#define IDNO 7
+#define STILL_ACTIVE 259
+#define PROCESS_ALL_ACCESS 0
+#define LOWORD(x) ((x) & 0xFFFF)
+#define HIWORD(x) (((x) >> 16) & 0xFFFF)
+#define min(a,b) (((a) < (b)) ? (a) : (b))
+#define max(a,b) (((a) > (b)) ? (a) : (b))
+
+//Defined by the driver
+BOOL ReadProcessMemory(HANDLE, LPCVOID, LPVOID, SIZE_T, SIZE_T*);
+BOOL WriteProcessMemory(HANDLE, LPVOID, LPCVOID, SIZE_T, SIZE_T*);
+LPVOID VirtualAllocEx(HANDLE, LPVOID, SIZE_T, DWORD, DWORD);
+HANDLE OpenProcess(DWORD, BOOL, DWORD);
+BOOL CloseHandle(HANDLE);
+BOOL GetExitCodeProcess(HANDLE, DWORD*);
+DWORD GetLastError();
+DWORD FormatMessageA(DWORD, LPCVOID, DWORD, DWORD, char*, DWORD, void*);
+DWORD GetTickCount();
+BOOL CreateDirectoryA(const char*, void*);
+BOOL CreateDirectory(LPCWSTR, void*);
+int MessageBox(HWND, LPCWSTR, LPCWSTR, UINT);
+int MessageBoxA(HWND, const char*, const char*, UINT);
+HWND GetActiveWindow();
+BOOL SetWindowText(HWND, LPCWSTR);
+int GetWindowText(HWND, LPWSTR, int);
+
+//Window functions - not called by the generators
+template <class... A> inline intptr_t SendMessage(A...) { return 0; }
+template <class... A> inline int ShowWindow(A...) { return 0; }
+template <class... A> inline void PostQuitMessage(A...) {}
+template <class... A> inline int IsDlgButtonChecked(A...) { return 0; }
+template <class... A> inline int EnableWindow(A...) { return 0; }
+template <class... A> inline int DestroyWindow(A...) { return 0; }
+template <class... A> inline intptr_t DefWindowProc(A...) { return 0; }
+template <class... A> inline int CheckDlgButton(A...) { return 0; }
+template <class... A> inline HWND CreateWindow(A...) { return nullptr; }
+template <class... A> inline HMODULE LoadLibrary(A...) { return nullptr; }
+template <class... A> inline void* LoadCursor(A...) { return nullptr; }
+template <class... A> inline int RegisterClassW(A...) { return 0; }
+template <class... A> inline int SetTimer(A...) { return 0; }
+template <class... A> inline int KillTimer(A...) { return 0; }
+template <class... A> inline int GetMessage(A...) { return 0; }
+template <class... A> inline int TranslateMessage(A...) { return 0; }
+template <class... A> inline intptr_t DispatchMessage(A...) { return 0; }
+template <class... A> inline int UpdateWindow(A...) { return 0; }
+template <class... A> inline int wcscpy_s(A...) { return 0; }
+template <class... A> inline HANDLE CreateFontW(A...) { return nullptr; }
+template <class... A> inline HANDLE CreateFont(A...) { return nullptr; }
+template <class... A> inline int SetFocus(A...) { return 0; }
+template <class... A> inline int SetWindowPos(A...) { return 0; }
+template <class... A> inline int InvalidateRect(A...) { return 0; }
+template <class... A> inline int GetDlgItemText(A...) { return 0; }
+inline int _wtoi(const wchar_t* s) { return static_cast<int>(wcstol(s, nullptr, 10)); }
+
+enum WindowConstants {
+	BM_SETCHECK = 1, BST_UNCHECKED, BST_CHECKED, BN_CLICKED, WM_TIMER, WM_DESTROY, WM_COMMAND, WM_CLOSE, WM_SETFONT, SW_SHOW, SW_HIDE, EN_CHANGE,
+	CS_HREDRAW, CS_VREDRAW, IDC_ARROW, COLOR_WINDOW, WS_OVERLAPPED, WS_OVERLAPPEDWINDOW, WS_TABSTOP, WS_VISIBLE, WS_CHILD, WS_BORDER, WS_VSCROLL, WS_GROUP,
+	SS_LEFT, SS_CENTER, ES_LEFT, ES_AUTOHSCROLL, ES_NUMBER, BS_AUTORADIOBUTTON, BS_MULTILINE, BS_DEFPUSHBUTTON, BS_CHECKBOX, BS_AUTOCHECKBOX,
+	CB_ADDSTRING, CB_SETCURSEL, CB_GETCURSEL, CBS_DROPDOWN, CBS_DROPDOWNLIST, CBS_HASSTRINGS, MB_ICONERROR, MB_ICONWARNING,
+};
+struct WNDCLASSW { int style; LRESULT(*lpfnWndProc)(HWND, UINT, WPARAM, LPARAM); int cbClsExtra; int cbWndExtra; HINSTANCE hInstance; void* hIcon; void* hCursor; HBRUSH hbrBackground; LPCWSTR lpszMenuName; LPCWSTR lpszClassName; };
+struct MSG { WPARAM wParam; };
+#define MSFTEDIT_CLASS L"RICHEDIT50W"
+#define EM_SETEVENTMASK 1
+#define ENM_CHANGE 1
+
+//MSVC lets std::exception take a message
+#define exception(...) runtime_error(std::string(__VA_ARGS__))